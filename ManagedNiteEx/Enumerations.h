@@ -51,4 +51,148 @@ namespace ManagedNiteEx
 		/** A Codec **/
 		Codec = XN_NODE_TYPE_CODEC,
 	};
-}
\ No newline at end of file
+
+	/** Layers blended by XnMCompositor **/
+	[System::Flags]
+	public enum class XnMCompositeLayers {
+		None = 0,
+
+		/** Histogram-equalized depth **/
+		Depth = 1,
+
+		/** RGB image **/
+		Image = 2,
+
+		/** User labels colored through the label color table **/
+		Labels = 4,
+
+		/** Dims background pixels so users stand out **/
+		Highlight = 8,
+	};
+
+	/** Skeleton joints, values match XnSkeletonJoint **/
+	public enum class XnMSkeletonJointType {
+		Head = XN_SKEL_HEAD,
+		Neck = XN_SKEL_NECK,
+		Torso = XN_SKEL_TORSO,
+		Waist = XN_SKEL_WAIST,
+
+		LeftCollar = XN_SKEL_LEFT_COLLAR,
+		LeftShoulder = XN_SKEL_LEFT_SHOULDER,
+		LeftElbow = XN_SKEL_LEFT_ELBOW,
+		LeftWrist = XN_SKEL_LEFT_WRIST,
+		LeftHand = XN_SKEL_LEFT_HAND,
+		LeftFingertip = XN_SKEL_LEFT_FINGERTIP,
+
+		RightCollar = XN_SKEL_RIGHT_COLLAR,
+		RightShoulder = XN_SKEL_RIGHT_SHOULDER,
+		RightElbow = XN_SKEL_RIGHT_ELBOW,
+		RightWrist = XN_SKEL_RIGHT_WRIST,
+		RightHand = XN_SKEL_RIGHT_HAND,
+		RightFingertip = XN_SKEL_RIGHT_FINGERTIP,
+
+		LeftHip = XN_SKEL_LEFT_HIP,
+		LeftKnee = XN_SKEL_LEFT_KNEE,
+		LeftAnkle = XN_SKEL_LEFT_ANKLE,
+		LeftFoot = XN_SKEL_LEFT_FOOT,
+
+		RightHip = XN_SKEL_RIGHT_HIP,
+		RightKnee = XN_SKEL_RIGHT_KNEE,
+		RightAnkle = XN_SKEL_RIGHT_ANKLE,
+		RightFoot = XN_SKEL_RIGHT_FOOT,
+	};
+
+	/** Sets of joints tracked by the skeleton capability **/
+	public enum class XnMSkeletonProfile {
+		None = XN_SKEL_PROFILE_NONE,
+		All = XN_SKEL_PROFILE_ALL,
+		Upper = XN_SKEL_PROFILE_UPPER,
+		Lower = XN_SKEL_PROFILE_LOWER,
+		HeadHands = XN_SKEL_PROFILE_HEAD_HANDS,
+	};
+
+	/** Skeleton state of a detected user **/
+	public enum class XnMSkeletonState {
+		Detected = 0,
+		Calibrating = 1,
+		Tracking = 2,
+	};
+
+	/** Temporal smoothing applied to joints and hand points **/
+	public enum class XnMJointFilterMode {
+		None = 0,
+
+		/** Holt double exponential smoothing with trend prediction **/
+		DoubleExponential = 1,
+
+		/** Speed adaptive low-pass (1-euro filter) **/
+		OneEuro = 2,
+	};
+
+	/** Binary point cloud file formats written by XnMPointCloudExporter **/
+	public enum class XnMPointCloudFormat {
+		/** Stanford polygon format, binary little endian **/
+		Ply = 0,
+
+		/** Point Cloud Library format, binary data **/
+		Pcd = 1,
+	};
+
+	/** Instruction set levels of the native kernels, values match Native::CpuLevel **/
+	public enum class XnMCpuLevel {
+		Scalar = 0,
+		Sse2 = 1,
+		Ssse3 = 2,
+		Avx2 = 3,
+	};
+
+	/** CPU features found at load, values match Native::CpuFeature **/
+	[System::Flags]
+	public enum class XnMCpuFeatures {
+		None = 0,
+		Sse2 = 1,
+		Sse3 = 2,
+		Ssse3 = 4,
+		Sse41 = 8,
+		Sse42 = 16,
+		Avx = 32,
+		Avx2 = 64,
+		Avx512F = 128,
+	};
+
+	/** Native kernels selected by XnMCpuDispatch, values match Native::CpuKernel **/
+	public enum class XnMCpuKernel {
+		/** Tile comparison of 8-bit maps **/
+		SpanChanged8 = 0,
+
+		/** Tile comparison of 16-bit maps **/
+		SpanChanged16 = 1,
+
+		/** Depth histogram of the compositor **/
+		DepthHistogram = 2,
+
+		/** Depth to camera space points **/
+		UnprojectRow = 3,
+
+		/** RGB24 to BGRA32 conversion **/
+		RgbToBgra = 4,
+	};
+
+	/** Products derived on demand by XnMFrameSet, values match Native::FrameProducts::Product **/
+	public enum class XnMFrameProduct {
+		/** Depth histogram **/
+		Histogram = 0,
+
+		/** Real world point per pixel **/
+		Points = 1,
+
+		/** Surface normal per pixel **/
+		Normals = 2,
+
+		/** BGRA32 copy of the image **/
+		Bgra = 3,
+
+		/** Pixel count, bounds and center of every user label **/
+		LabelStats = 4,
+	};
+}
@@ -0,0 +1,171 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "Compositor.h"
+#include "CpuDispatch.h"
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// same palette as the WPF viewer's SceneMap (Red, Blue, Green, Violet, Orange,
+		// Pink, Magenta, Lime, Yellow, Indigo)
+		static const XnUInt32 s_defaultPalette[] = 
+		{
+			0xFFFF0000, 0xFF0000FF, 0xFF008000, 0xFFEE82EE, 0xFFFFA500,
+			0xFFFFC0CB, 0xFFFF00FF, 0xFF00FF00, 0xFFFFFF00, 0xFF4B0082
+		};
+
+		static inline XnUInt8 Blend(XnUInt32 nDst, XnUInt32 nSrc, XnUInt32 nAlpha)
+		{
+			return (XnUInt8)((nSrc * nAlpha + nDst * (255 - nAlpha) + 127) / 255);
+		}
+
+		Compositor::Compositor()
+			: m_nLayers(LAYER_DEPTH | LAYER_LABELS),
+			  m_nDepthAlpha(128),
+			  m_nBackgroundLevel(96)
+		{
+			const XnUInt32 nPalette = sizeof(s_defaultPalette) / sizeof(s_defaultPalette[0]);
+
+			m_labelColors[0] = 0;
+			for (XnUInt32 i = 1; i < LABEL_COLORS; ++i)
+			{
+				m_labelColors[i] = s_defaultPalette[i % nPalette];
+			}
+			memset(m_depthLut, 0, sizeof(m_depthLut));
+		}
+
+		void Compositor::BuildDepthLut(const XnUInt16* pDepth, XnUInt32 nCount)
+		{
+			memset(m_histogram, 0, sizeof(m_histogram));
+			XnUInt32 nPoints = CpuDispatch::GetKernels().pDepthHistogram(pDepth, nCount, m_histogram, MAX_DEPTH);
+
+			// cumulative histogram mapped so that near points are bright
+			XnUInt32 nSum = 0;
+			m_depthLut[0] = 0;
+			for (XnUInt32 i = 1; i < MAX_DEPTH; ++i)
+			{
+				nSum += m_histogram[i];
+				m_depthLut[i] = (nPoints == 0) ? 0 : (XnUInt8)(255 - (XnUInt64)255 * nSum / nPoints);
+			}
+		}
+
+		XnStatus Compositor::Compose(const CompositorInput& input, XnUInt8* pDest, XnUInt32 nDestWidth, XnUInt32 nDestHeight, XnInt32 nDestStride)
+		{
+			if (pDest == NULL)
+				return XN_STATUS_NULL_INPUT_PTR;
+			if (nDestStride < 0 || (XnUInt64)nDestStride < (XnUInt64)nDestWidth * 4)
+				return XN_STATUS_BAD_PARAM;
+
+			if ((m_nLayers & LAYER_DEPTH) && input.pDepth == NULL)
+				return XN_STATUS_BAD_PARAM;
+			if ((m_nLayers & LAYER_IMAGE) && input.pImage == NULL)
+				return XN_STATUS_BAD_PARAM;
+			if ((m_nLayers & (LAYER_LABELS | LAYER_HIGHLIGHT)) && input.pLabels == NULL)
+				return XN_STATUS_BAD_PARAM;
+
+			if (input.nXOffset + input.nXRes > nDestWidth || input.nYOffset + input.nYRes > nDestHeight)
+				return XN_STATUS_BAD_PARAM;
+
+			if (m_nLayers & LAYER_DEPTH)
+				BuildDepthLut(input.pDepth, input.nXRes * input.nYRes);
+
+			XnUInt8* pOrigin = pDest + (XnInt64)input.nYOffset * nDestStride + input.nXOffset * 4;
+			const XnUInt32 nTiles = (input.nYRes + TILE_ROWS - 1) / TILE_ROWS;
+
+			Concurrency::parallel_for(0u, nTiles, [&](XnUInt32 nTile)
+			{
+				XnUInt32 nFirstRow = nTile * TILE_ROWS;
+				XnUInt32 nLastRow = (nFirstRow + TILE_ROWS < input.nYRes) ? nFirstRow + TILE_ROWS : input.nYRes;
+				ComposeRows(input, nFirstRow, nLastRow, pOrigin, nDestStride);
+			});
+
+			return XN_STATUS_OK;
+		}
+
+		void Compositor::ComposeRows(const CompositorInput& input, XnUInt32 nFirstRow, XnUInt32 nLastRow, XnUInt8* pOrigin, XnInt32 nDestStride) const
+		{
+			const bool bDepth = (m_nLayers & LAYER_DEPTH) != 0;
+			const bool bImage = (m_nLayers & LAYER_IMAGE) != 0;
+			const bool bLabels = (m_nLayers & LAYER_LABELS) != 0;
+			const bool bHighlight = (m_nLayers & LAYER_HIGHLIGHT) != 0;
+			const XnUInt32 nDepthAlpha = bImage ? m_nDepthAlpha : 255;
+
+			// the image alone is a plain format conversion
+			if (m_nLayers == LAYER_IMAGE)
+			{
+				const CpuKernels& kernels = CpuDispatch::GetKernels();
+				for (XnUInt32 y = nFirstRow; y < nLastRow; ++y)
+				{
+					kernels.pRgbToBgra(input.pImage + y * input.nXRes * 3, input.nXRes, pOrigin + (XnInt64)y * nDestStride);
+				}
+				return;
+			}
+
+			for (XnUInt32 y = nFirstRow; y < nLastRow; ++y)
+			{
+				const XnUInt32 nRowStart = y * input.nXRes;
+				const XnUInt16* pDepth = bDepth ? input.pDepth + nRowStart : NULL;
+				const XnUInt8* pImage = bImage ? input.pImage + nRowStart * 3 : NULL;
+				const XnUInt16* pLabels = (bLabels || bHighlight) ? input.pLabels + nRowStart : NULL;
+				XnUInt8* pOut = pOrigin + (XnInt64)y * nDestStride;
+
+				for (XnUInt32 x = 0; x < input.nXRes; ++x, pOut += 4)
+				{
+					XnUInt32 b = 0, g = 0, r = 0, a = 0;
+
+					if (bImage)
+					{
+						r = pImage[x * 3];
+						g = pImage[x * 3 + 1];
+						b = pImage[x * 3 + 2];
+						a = 255;
+					}
+
+					if (bDepth)
+					{
+						XnUInt16 d = pDepth[x];
+						if (d != 0 && d < MAX_DEPTH)
+						{
+							// depth is painted as yellow
+							XnUInt32 val = m_depthLut[d];
+							r = Blend(r, val, nDepthAlpha);
+							g = Blend(g, val, nDepthAlpha);
+							b = Blend(b, 0, nDepthAlpha);
+							a = 255;
+						}
+					}
+
+					if (pLabels != NULL)
+					{
+						XnUInt16 label = pLabels[x];
+						if (label != 0)
+						{
+							if (bLabels)
+							{
+								XnUInt32 color = m_labelColors[label % LABEL_COLORS];
+								XnUInt32 ca = color >> 24;
+								r = Blend(r, (color >> 16) & 0xFF, ca);
+								g = Blend(g, (color >> 8) & 0xFF, ca);
+								b = Blend(b, color & 0xFF, ca);
+								a = (a > ca) ? a : ca;
+							}
+						}
+						else if (bHighlight)
+						{
+							r = r * m_nBackgroundLevel / 255;
+							g = g * m_nBackgroundLevel / 255;
+							b = b * m_nBackgroundLevel / 255;
+						}
+					}
+
+					pOut[0] = (XnUInt8)b;
+					pOut[1] = (XnUInt8)g;
+					pOut[2] = (XnUInt8)r;
+					pOut[3] = (XnUInt8)a;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <XnOS.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Source maps of one frame set. Unused layers may be NULL; all maps share the resolution.
+		struct CompositorInput
+		{
+			const XnUInt16* pDepth;
+			const XnUInt8* pImage;		// RGB24
+			const XnUInt16* pLabels;
+			XnUInt32 nXRes;
+			XnUInt32 nYRes;
+			XnUInt32 nXOffset;
+			XnUInt32 nYOffset;
+		};
+
+		// Blends histogram-equalized depth, RGB, colored user labels and a foreground
+		// highlight into one BGRA32 destination in a single tiled, parallel pass.
+		class Compositor
+		{
+		public:
+			enum Layer
+			{
+				LAYER_DEPTH = 1,
+				LAYER_IMAGE = 2,
+				LAYER_LABELS = 4,
+				LAYER_HIGHLIGHT = 8
+			};
+
+			static const XnUInt32 MAX_DEPTH = 10000;
+			static const XnUInt32 LABEL_COLORS = 256;
+			static const XnUInt32 TILE_ROWS = 16;
+
+			Compositor();
+
+			XnUInt32 GetLayers() const { return m_nLayers; }
+			void SetLayers(XnUInt32 nLayers) { m_nLayers = nLayers; }
+
+			// Opacity of the depth layer when drawn over the RGB image.
+			XnUInt8 GetDepthAlpha() const { return m_nDepthAlpha; }
+			void SetDepthAlpha(XnUInt8 nAlpha) { m_nDepthAlpha = nAlpha; }
+
+			// Intensity (0-255) kept for background pixels when the highlight layer is on.
+			XnUInt8 GetBackgroundLevel() const { return m_nBackgroundLevel; }
+			void SetBackgroundLevel(XnUInt8 nLevel) { m_nBackgroundLevel = nLevel; }
+
+			// Color is packed as 0xAARRGGBB; labels wrap around the table size.
+			XnUInt32 GetLabelColor(XnUInt16 nLabel) const { return m_labelColors[nLabel % LABEL_COLORS]; }
+			void SetLabelColor(XnUInt16 nLabel, XnUInt32 nArgb) { m_labelColors[nLabel % LABEL_COLORS] = nArgb; }
+
+			// Composes the frame into pDest at the crop offset of the input maps.
+			XnStatus Compose(const CompositorInput& input, XnUInt8* pDest, XnUInt32 nDestWidth, XnUInt32 nDestHeight, XnInt32 nDestStride);
+
+		private:
+			void BuildDepthLut(const XnUInt16* pDepth, XnUInt32 nCount);
+			void ComposeRows(const CompositorInput& input, XnUInt32 nFirstRow, XnUInt32 nLastRow, XnUInt8* pDest, XnInt32 nDestStride) const;
+
+			XnUInt32 m_nLayers;
+			XnUInt8 m_nDepthAlpha;
+			XnUInt8 m_nBackgroundLevel;
+			XnUInt32 m_labelColors[LABEL_COLORS];
+			XnUInt32 m_histogram[MAX_DEPTH];
+			XnUInt8 m_depthLut[MAX_DEPTH];
+		};
+	}
+}
@@ -0,0 +1,322 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "ContourTracer.h"
+#include <math.h>
+#include <string.h>
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// crack directions: right, down, left, up (y grows downwards)
+		static const XnInt32 DIR_X[4] = { 1, 0, -1, 0 };
+		static const XnInt32 DIR_Y[4] = { 0, 1, 0, -1 };
+		static const int DIR_UP = 3;
+
+		// pixels ahead of a corner on the left and right side of each direction
+		static const XnInt32 LEFT_AHEAD_X[4] = { 0, 0, -1, -1 };
+		static const XnInt32 LEFT_AHEAD_Y[4] = { -1, 0, 0, -1 };
+		static const XnInt32 RIGHT_AHEAD_X[4] = { 0, -1, -1, 0 };
+		static const XnInt32 RIGHT_AHEAD_Y[4] = { 0, 0, -1, -1 };
+
+		struct ContourCandidate
+		{
+			XnUInt16 nLabel;
+			XnInt32 nArea;
+			XnUInt32 nTraced;
+		};
+
+		static inline bool IsLabel(const XnUInt16* pLabels, XnInt32 nXRes, XnInt32 nYRes, XnInt32 x, XnInt32 y, XnUInt16 nLabel)
+		{
+			return x >= 0 && y >= 0 && x < nXRes && y < nYRes && pLabels[y * nXRes + x] == nLabel;
+		}
+
+		template<class TCorner>
+		static float DistanceToSegment(const TCorner& p, const TCorner& a, const TCorner& b)
+		{
+			float dx = (float)(b.x - a.x);
+			float dy = (float)(b.y - a.y);
+			float px = (float)(p.x - a.x);
+			float py = (float)(p.y - a.y);
+			float len = dx * dx + dy * dy;
+			if (len == 0.0f)
+				return sqrtf(px * px + py * py);
+			return fabsf(px * dy - py * dx) / sqrtf(len);
+		}
+
+		// Vertices without depth of their own get the depth interpolated between the nearest
+		// vertices with depth on either side along the closed polygon.
+		static void FillMissingDepth(XnPoint3D* pPoints, XnUInt32 nCount)
+		{
+			XnUInt32 nStart = 0;
+			while (nStart < nCount && pPoints[nStart].Z == 0)
+				++nStart;
+			if (nStart == nCount)
+				return;
+
+			// offsets from nStart, the walk ends back on nStart
+			XnUInt32 nPrev = 0;
+			for (XnUInt32 n = 1; n <= nCount; ++n)
+			{
+				const XnPoint3D& next = pPoints[(nStart + n) % nCount];
+				if (next.Z == 0)
+					continue;
+
+				const XnFloat fPrevZ = pPoints[(nStart + nPrev) % nCount].Z;
+				const XnUInt32 nGap = n - nPrev;
+				for (XnUInt32 k = 1; k < nGap; ++k)
+					pPoints[(nStart + nPrev + k) % nCount].Z = fPrevZ + (next.Z - fPrevZ) * k / nGap;
+				nPrev = n;
+			}
+		}
+
+		// Douglas-Peucker on the open run [first, last] of a closed polygon (last may wrap to 0)
+		template<class TCorner>
+		static void Simplify(const std::vector<TCorner>& corners, XnUInt32 nFirst, XnUInt32 nLast, float fTolerance, std::vector<XnUInt8>& keep)
+		{
+			const XnUInt32 nCount = (XnUInt32)corners.size();
+			std::vector<std::pair<XnUInt32, XnUInt32> > stack;
+			stack.push_back(std::make_pair(nFirst, nLast));
+
+			while (!stack.empty())
+			{
+				XnUInt32 a = stack.back().first;
+				XnUInt32 b = stack.back().second;
+				stack.pop_back();
+
+				float fMax = 0.0f;
+				XnUInt32 nFarthest = a;
+				for (XnUInt32 i = a + 1; i < b; ++i)
+				{
+					float d = DistanceToSegment(corners[i], corners[a], corners[b % nCount]);
+					if (d > fMax)
+					{
+						fMax = d;
+						nFarthest = i;
+					}
+				}
+
+				if (fMax > fTolerance)
+				{
+					keep[nFarthest] = 1;
+					stack.push_back(std::make_pair(a, nFarthest));
+					stack.push_back(std::make_pair(nFarthest, b));
+				}
+			}
+		}
+
+		ContourTracer::ContourTracer()
+			: m_fTolerance(1.0f), m_nMinArea(0), m_bIncludeHoles(true)
+		{
+		}
+
+		void ContourTracer::Follow(const XnUInt16* pLabels, XnUInt32 nXRes, XnUInt32 nYRes,
+			XnInt32 nStartX, XnInt32 nStartY, std::vector<Corner>& corners)
+		{
+			const XnInt32 w = (XnInt32)nXRes;
+			const XnInt32 h = (XnInt32)nYRes;
+			const XnUInt16 nLabel = pLabels[nStartY * w + nStartX];
+
+			// start on the left crack of the pixel going up, keeping the region on the right
+			XnInt32 cx = nStartX;
+			XnInt32 cy = nStartY + 1;
+			int d = DIR_UP;
+			corners.clear();
+
+			do
+			{
+				if (d == DIR_UP)
+					m_visited[(cy - 1) * w + cx] = 1;
+
+				cx += DIR_X[d];
+				cy += DIR_Y[d];
+
+				int nd;
+				if (!IsLabel(pLabels, w, h, cx + RIGHT_AHEAD_X[d], cy + RIGHT_AHEAD_Y[d], nLabel))
+					nd = (d + 1) & 3;
+				else if (IsLabel(pLabels, w, h, cx + LEFT_AHEAD_X[d], cy + LEFT_AHEAD_Y[d], nLabel))
+					nd = (d + 3) & 3;
+				else
+					nd = d;
+
+				if (nd != d)
+				{
+					Corner corner = { cx, cy };
+					corners.push_back(corner);
+					d = nd;
+				}
+			}
+			while (cx != nStartX || cy != nStartY + 1 || d != DIR_UP);
+		}
+
+		XnUInt32 ContourTracer::Trace(const XnUInt16* pLabels, const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes)
+		{
+			m_contours.clear();
+			m_points.clear();
+			if (pLabels == NULL || nXRes == 0 || nYRes == 0)
+				return 0;
+
+			m_visited.assign((size_t)nXRes * nYRes, 0);
+
+			// single raster scan - every unvisited left crack of a labeled pixel starts a new boundary
+			std::vector<ContourCandidate> candidates;
+			XnUInt32 nTraced = 0;
+			for (XnUInt32 y = 0; y < nYRes; ++y)
+			{
+				const XnUInt16* pRow = pLabels + y * nXRes;
+				for (XnUInt32 x = 0; x < nXRes; ++x)
+				{
+					XnUInt16 nLabel = pRow[x];
+					if (nLabel == 0 || (x > 0 && pRow[x - 1] == nLabel) || m_visited[y * nXRes + x])
+						continue;
+
+					if (nTraced == m_traced.size())
+						m_traced.resize(nTraced + 1);
+					std::vector<Corner>& corners = m_traced[nTraced];
+					Follow(pLabels, nXRes, nYRes, x, y, corners);
+
+					// outer boundaries run clockwise on screen and have a positive area
+					XnInt64 nDoubleArea = 0;
+					for (size_t i = 0; i < corners.size(); ++i)
+					{
+						const Corner& a = corners[i];
+						const Corner& b = corners[(i + 1) % corners.size()];
+						nDoubleArea += (XnInt64)a.x * b.y - (XnInt64)b.x * a.y;
+					}
+
+					XnInt32 nArea = (XnInt32)(nDoubleArea / 2);
+					if ((XnUInt32)(nArea < 0 ? -nArea : nArea) < m_nMinArea || (nArea < 0 && !m_bIncludeHoles))
+						continue;
+
+					ContourCandidate candidate = { nLabel, nArea, nTraced };
+					candidates.push_back(candidate);
+					++nTraced;
+				}
+			}
+
+			if (candidates.empty())
+				return 0;
+
+			// simplify every polygon in parallel
+			std::vector<std::vector<XnUInt8> > keep(candidates.size());
+			const float fTolerance = m_fTolerance;
+			Concurrency::parallel_for(0, (int)candidates.size(), [&](int i)
+			{
+				const std::vector<Corner>& corners = m_traced[candidates[i].nTraced];
+				std::vector<XnUInt8>& flags = keep[i];
+				XnUInt32 nCount = (XnUInt32)corners.size();
+
+				if (fTolerance <= 0.0f || nCount <= 4)
+				{
+					flags.assign(nCount, 1);
+					return;
+				}
+
+				flags.assign(nCount, 0);
+
+				// split the closed polygon at the corner farthest from the first one
+				XnUInt32 nFarthest = 0;
+				XnInt64 nMax = -1;
+				for (XnUInt32 j = 1; j < nCount; ++j)
+				{
+					XnInt64 dx = corners[j].x - corners[0].x;
+					XnInt64 dy = corners[j].y - corners[0].y;
+					if (dx * dx + dy * dy > nMax)
+					{
+						nMax = dx * dx + dy * dy;
+						nFarthest = j;
+					}
+				}
+
+				flags[0] = 1;
+				flags[nFarthest] = 1;
+				Simplify(corners, 0, nFarthest, fTolerance, flags);
+				Simplify(corners, nFarthest, nCount, fTolerance, flags);
+			});
+
+			// lay the polygons out back to back
+			m_contours.resize(candidates.size());
+			XnUInt32 nPoints = 0;
+			for (size_t i = 0; i < candidates.size(); ++i)
+			{
+				Contour& contour = m_contours[i];
+				contour.nLabel = candidates[i].nLabel;
+				contour.nArea = candidates[i].nArea;
+				contour.bHole = candidates[i].nArea < 0;
+				contour.nFirstPoint = nPoints;
+				contour.nPointCount = 0;
+				for (size_t j = 0; j < keep[i].size(); ++j)
+					contour.nPointCount += keep[i][j];
+				nPoints += contour.nPointCount;
+			}
+			m_points.resize(nPoints);
+
+			const XnInt32 w = (XnInt32)nXRes;
+			const XnInt32 h = (XnInt32)nYRes;
+			Concurrency::parallel_for(0, (int)candidates.size(), [&](int i)
+			{
+				const std::vector<Corner>& corners = m_traced[candidates[i].nTraced];
+				const Contour& contour = m_contours[i];
+				XnPoint3D* pOut = &m_points[contour.nFirstPoint];
+
+				for (size_t j = 0; j < corners.size(); ++j)
+				{
+					if (!keep[i][j])
+						continue;
+
+					const Corner& c = corners[j];
+					pOut->X = (XnFloat)c.x;
+					pOut->Y = (XnFloat)c.y;
+					pOut->Z = 0;
+
+					// depth of a pixel of the region touching the corner
+					if (pDepth != NULL)
+					{
+						static const XnInt32 dx[4] = { 0, -1, 0, -1 };
+						static const XnInt32 dy[4] = { 0, 0, -1, -1 };
+						for (int k = 0; k < 4; ++k)
+						{
+							XnInt32 px = c.x + dx[k];
+							XnInt32 py = c.y + dy[k];
+							if (IsLabel(pLabels, w, h, px, py, contour.nLabel) && pDepth[py * w + px] != 0)
+							{
+								pOut->Z = pDepth[py * w + px];
+								break;
+							}
+						}
+					}
+					++pOut;
+				}
+
+				if (pDepth != NULL)
+					FillMissingDepth(&m_points[contour.nFirstPoint], contour.nPointCount);
+			});
+
+			return (XnUInt32)m_contours.size();
+		}
+
+		XnUInt32 ContourTracer::RemoveContoursWithoutDepth()
+		{
+			// after FillMissingDepth a contour has depth everywhere or nowhere
+			size_t nContours = 0;
+			XnUInt32 nPoints = 0;
+			for (size_t i = 0; i < m_contours.size(); ++i)
+			{
+				Contour contour = m_contours[i];
+				if (contour.nPointCount == 0 || m_points[contour.nFirstPoint].Z == 0)
+					continue;
+
+				if (nPoints != contour.nFirstPoint)
+					memmove(&m_points[nPoints], &m_points[contour.nFirstPoint], contour.nPointCount * sizeof(XnPoint3D));
+				contour.nFirstPoint = nPoints;
+				nPoints += contour.nPointCount;
+				m_contours[nContours++] = contour;
+			}
+
+			m_contours.resize(nContours);
+			m_points.resize(nPoints);
+			return (XnUInt32)nContours;
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <XnOS.h>
+#include <vector>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		struct Contour
+		{
+			XnUInt16 nLabel;
+			bool bHole;				// boundary of a region of other labels enclosed by the label
+			XnInt32 nArea;			// enclosed area in pixels (holes are negative)
+			XnUInt32 nFirstPoint;
+			XnUInt32 nPointCount;
+		};
+
+		// Extracts the outer and hole boundaries of every label of a label map in a single 
+		// scan by following pixel cracks. Regions are 4-connected. Vertices lie on pixel 
+		// corners, with X and Y in map coordinates and Z holding the depth of an adjacent pixel.
+		class ContourTracer
+		{
+		public:
+			ContourTracer();
+
+			// Maximal distance (pixels) of removed vertices from the simplified polygon, 0 keeps all corners.
+			float GetTolerance() const { return m_fTolerance; }
+			void SetTolerance(float fTolerance) { m_fTolerance = fTolerance; }
+
+			// Contours enclosing fewer pixels are dropped.
+			XnUInt32 GetMinArea() const { return m_nMinArea; }
+			void SetMinArea(XnUInt32 nArea) { m_nMinArea = nArea; }
+
+			bool GetIncludeHoles() const { return m_bIncludeHoles; }
+			void SetIncludeHoles(bool bInclude) { m_bIncludeHoles = bInclude; }
+
+			// Traces the label map. pDepth is optional and must match the label map.
+			// Vertices whose adjacent region pixels all lack depth get a depth interpolated
+			// from the neighbouring vertices of their contour; only contours without any
+			// depth keep Z = 0. Returns the number of contours.
+			XnUInt32 Trace(const XnUInt16* pLabels, const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes);
+
+			// Drops the contours without depth at any vertex and packs the remaining points.
+			// Returns the number of contours.
+			XnUInt32 RemoveContoursWithoutDepth();
+
+			XnUInt32 GetContourCount() const { return (XnUInt32)m_contours.size(); }
+			const Contour* GetContours() const { return m_contours.empty() ? NULL : &m_contours[0]; }
+
+			XnUInt32 GetPointCount() const { return (XnUInt32)m_points.size(); }
+			const XnPoint3D* GetPoints() const { return m_points.empty() ? NULL : &m_points[0]; }
+			XnPoint3D* GetPoints() { return m_points.empty() ? NULL : &m_points[0]; }
+
+		private:
+			struct Corner
+			{
+				XnInt32 x;
+				XnInt32 y;
+			};
+
+			void Follow(const XnUInt16* pLabels, XnUInt32 nXRes, XnUInt32 nYRes,
+				XnInt32 nStartX, XnInt32 nStartY, std::vector<Corner>& corners);
+
+			float m_fTolerance;
+			XnUInt32 m_nMinArea;
+			bool m_bIncludeHoles;
+
+			// visited upward cracks, one per pixel (the crack on its left side)
+			std::vector<XnUInt8> m_visited;
+			std::vector<std::vector<Corner> > m_traced;
+			std::vector<Contour> m_contours;
+			std::vector<XnPoint3D> m_points;
+		};
+	}
+}
@@ -0,0 +1,327 @@
+// Native (non /clr) translation unit - CPUID detection and kernel selection.
+
+#include "CpuKernels.h"
+#include <windows.h>
+#include <intrin.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		static const char* const s_levelNames[CPU_LEVEL_COUNT] = { "scalar", "sse2", "ssse3", "avx2" };
+		static const char* const s_kernelNames[CPU_KERNEL_COUNT] =
+		{
+			"SpanChanged8", "SpanChanged16", "DepthHistogram", "UnprojectRow", "RgbToBgra"
+		};
+
+		static XnUInt32 s_nFeatures = 0;
+		static CpuLevel s_supportedLevel = CPU_LEVEL_SCALAR;
+		static CpuLevel s_level = CPU_LEVEL_SCALAR;
+		static bool s_bVerify = false;
+		static volatile LONG s_bInitialized = 0;
+
+		// the table handed out to callers and, while verifying, the table under test
+		static const CpuKernels* volatile s_pActive = NULL;
+		static const CpuKernels* volatile s_pVerified = NULL;
+
+		static volatile LONG s_mismatches[CPU_KERNEL_COUNT];
+
+		static XnUInt32 DetectFeatures()
+		{
+			int regs[4];
+			__cpuid(regs, 0);
+			const int nMaxLeaf = regs[0];
+			if (nMaxLeaf < 1)
+				return 0;
+
+			XnUInt32 nFeatures = 0;
+			__cpuid(regs, 1);
+			const int ecx = regs[2];
+			const int edx = regs[3];
+			if (edx & (1 << 26)) nFeatures |= CPU_FEATURE_SSE2;
+			if (ecx & (1 << 0)) nFeatures |= CPU_FEATURE_SSE3;
+			if (ecx & (1 << 9)) nFeatures |= CPU_FEATURE_SSSE3;
+			if (ecx & (1 << 19)) nFeatures |= CPU_FEATURE_SSE41;
+			if (ecx & (1 << 20)) nFeatures |= CPU_FEATURE_SSE42;
+
+			// AVX registers are usable only when the OS saves them on context switches
+			bool bYmm = false;
+			bool bZmm = false;
+			if ((ecx & (1 << 27)) && (ecx & (1 << 28)))
+			{
+				XnUInt64 xcr0 = _xgetbv(0);
+				bYmm = (xcr0 & 0x06) == 0x06;
+				bZmm = (xcr0 & 0xE6) == 0xE6;
+			}
+
+			if (bYmm)
+			{
+				nFeatures |= CPU_FEATURE_AVX;
+				if (nMaxLeaf >= 7)
+				{
+					__cpuidex(regs, 7, 0);
+					if (regs[1] & (1 << 5)) nFeatures |= CPU_FEATURE_AVX2;
+					if (bZmm && (regs[1] & (1 << 16))) nFeatures |= CPU_FEATURE_AVX512F;
+				}
+			}
+			return nFeatures;
+		}
+
+		static const CpuKernels& GetLevelKernels(CpuLevel level)
+		{
+			switch (level)
+			{
+			case CPU_LEVEL_SSE2:
+				return GetSse2Kernels();
+			case CPU_LEVEL_SSSE3:
+				return GetSsse3Kernels();
+#ifdef MANAGEDNITEEX_CPU_AVX2
+			case CPU_LEVEL_AVX2:
+				return GetAvx2Kernels();
+#endif
+			default:
+				return GetScalarKernels();
+			}
+		}
+
+		//---------------------------------------------------------------------------
+		// Verification - runs the level under test and the scalar reference
+		//---------------------------------------------------------------------------
+
+		static void ReportMismatch(CpuKernel kernel)
+		{
+			// the first mismatch of each kernel goes to the debugger output
+			if (InterlockedIncrement(&s_mismatches[kernel]) == 1)
+			{
+				char message[160];
+				sprintf_s(message, sizeof(message), "ManagedNiteEx: %s kernel at level %s differs from the scalar reference\n",
+					s_kernelNames[kernel], s_levelNames[s_level]);
+				OutputDebugStringA(message);
+			}
+		}
+
+		static bool VerifySpanChanged8(const XnUInt8* pCur, const XnUInt8* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			bool bResult = s_pVerified->pSpanChanged8(pCur, pPrev, nCount, nTolerance);
+			if (bResult != GetScalarKernels().pSpanChanged8(pCur, pPrev, nCount, nTolerance))
+				ReportMismatch(CPU_KERNEL_SPAN_CHANGED8);
+			return bResult;
+		}
+
+		static bool VerifySpanChanged16(const XnUInt16* pCur, const XnUInt16* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			bool bResult = s_pVerified->pSpanChanged16(pCur, pPrev, nCount, nTolerance);
+			if (bResult != GetScalarKernels().pSpanChanged16(pCur, pPrev, nCount, nTolerance))
+				ReportMismatch(CPU_KERNEL_SPAN_CHANGED16);
+			return bResult;
+		}
+
+		static XnUInt32 VerifyDepthHistogram(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32* pHistogram, XnUInt32 nMaxDepth)
+		{
+			if (nMaxDepth == 0)
+				return s_pVerified->pDepthHistogram(pDepth, nCount, pHistogram, nMaxDepth);
+
+			// the histogram accumulates, so the reference starts from the caller's counts
+			std::vector<XnUInt32> reference(pHistogram, pHistogram + nMaxDepth);
+			XnUInt32 nResult = s_pVerified->pDepthHistogram(pDepth, nCount, pHistogram, nMaxDepth);
+			XnUInt32 nReference = GetScalarKernels().pDepthHistogram(pDepth, nCount, &reference[0], nMaxDepth);
+
+			if (nResult != nReference || memcmp(pHistogram, &reference[0], nMaxDepth * sizeof(XnUInt32)) != 0)
+				ReportMismatch(CPU_KERNEL_DEPTH_HISTOGRAM);
+			return nResult;
+		}
+
+		static void VerifyUnprojectRow(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32 nRow, const DepthIntrinsics& intrinsics, float* pXyz)
+		{
+			s_pVerified->pUnprojectRow(pDepth, nCount, nRow, intrinsics, pXyz);
+			if (nCount == 0)
+				return;
+
+			std::vector<float> reference(nCount * 3);
+			GetScalarKernels().pUnprojectRow(pDepth, nCount, nRow, intrinsics, &reference[0]);
+
+			// The kernels do the float operations of DepthIntrinsics::Unproject in the same order,
+			// so the rows are bit identical. Only x87 builds (/arch:IA32) keep the scalar
+			// intermediates at higher precision and compare with a relative tolerance.
+#if defined(_M_IX86_FP) && _M_IX86_FP == 0
+			for (XnUInt32 i = 0; i < nCount * 3; ++i)
+			{
+				float fRef = reference[i];
+				if (fabsf(pXyz[i] - fRef) > 1e-5f * (fabsf(fRef) > 1.0f ? fabsf(fRef) : 1.0f))
+				{
+					ReportMismatch(CPU_KERNEL_UNPROJECT_ROW);
+					break;
+				}
+			}
+#else
+			if (memcmp(pXyz, &reference[0], reference.size() * sizeof(float)) != 0)
+				ReportMismatch(CPU_KERNEL_UNPROJECT_ROW);
+#endif
+		}
+
+		static void VerifyRgbToBgra(const XnUInt8* pRgb, XnUInt32 nCount, XnUInt8* pBgra)
+		{
+			s_pVerified->pRgbToBgra(pRgb, nCount, pBgra);
+			if (nCount == 0)
+				return;
+
+			std::vector<XnUInt8> reference(nCount * 4);
+			GetScalarKernels().pRgbToBgra(pRgb, nCount, &reference[0]);
+			if (memcmp(pBgra, &reference[0], reference.size()) != 0)
+				ReportMismatch(CPU_KERNEL_RGB_TO_BGRA);
+		}
+
+		static const CpuKernels s_verifyKernels =
+		{
+			VerifySpanChanged8, VerifySpanChanged16, VerifyDepthHistogram, VerifyUnprojectRow, VerifyRgbToBgra
+		};
+
+		//---------------------------------------------------------------------------
+		// Selection
+		//---------------------------------------------------------------------------
+
+		static void ApplySelection()
+		{
+			// publish the table under test before the verifying table can call it
+			s_pVerified = &GetLevelKernels(s_level);
+			MemoryBarrier();
+			s_pActive = s_bVerify ? &s_verifyKernels : s_pVerified;
+		}
+
+		static bool ReadEnvironment(const char* strName, char* strValue, DWORD nSize)
+		{
+			DWORD nLength = GetEnvironmentVariableA(strName, strValue, nSize);
+			return nLength > 0 && nLength < nSize;
+		}
+
+		static void Initialize()
+		{
+			// racing callers compute the same selection, so a repeated run is harmless
+			s_nFeatures = DetectFeatures();
+
+			s_supportedLevel = CPU_LEVEL_SCALAR;
+			if (s_nFeatures & CPU_FEATURE_SSE2)
+				s_supportedLevel = CPU_LEVEL_SSE2;
+			if ((s_nFeatures & CPU_FEATURE_SSE2) && (s_nFeatures & CPU_FEATURE_SSSE3))
+				s_supportedLevel = CPU_LEVEL_SSSE3;
+#ifdef MANAGEDNITEEX_CPU_AVX2
+			if (s_supportedLevel == CPU_LEVEL_SSSE3 && (s_nFeatures & CPU_FEATURE_AVX2))
+				s_supportedLevel = CPU_LEVEL_AVX2;
+#endif
+			s_level = s_supportedLevel;
+
+			char strValue[32];
+			if (ReadEnvironment("MANAGEDNITEEX_CPU_LEVEL", strValue, sizeof(strValue)))
+			{
+				for (int i = 0; i < CPU_LEVEL_COUNT; ++i)
+				{
+					if (_stricmp(strValue, s_levelNames[i]) == 0)
+					{
+						// a level the machine cannot run falls back to the best supported one
+						s_level = (CpuLevel)i <= s_supportedLevel ? (CpuLevel)i : s_supportedLevel;
+						break;
+					}
+				}
+			}
+
+			if (ReadEnvironment("MANAGEDNITEEX_CPU_VERIFY", strValue, sizeof(strValue)))
+			{
+				s_bVerify = strcmp(strValue, "1") == 0 || _stricmp(strValue, "true") == 0;
+			}
+
+			ApplySelection();
+			InterlockedExchange(&s_bInitialized, 1);
+		}
+
+		// selects the kernels while the library loads
+		static struct CpuDispatchInitializer
+		{
+			CpuDispatchInitializer() { if (!s_bInitialized) Initialize(); }
+		} s_initializer;
+
+		const CpuKernels& CpuDispatch::GetKernels()
+		{
+			// static initializers of other translation units may run first
+			if (!s_bInitialized)
+				Initialize();
+			return *s_pActive;
+		}
+
+		XnUInt32 CpuDispatch::GetFeatures()
+		{
+			GetKernels();
+			return s_nFeatures;
+		}
+
+		CpuLevel CpuDispatch::GetSupportedLevel()
+		{
+			GetKernels();
+			return s_supportedLevel;
+		}
+
+		CpuLevel CpuDispatch::GetLevel()
+		{
+			GetKernels();
+			return s_level;
+		}
+
+		XnStatus CpuDispatch::SetLevel(CpuLevel level)
+		{
+			GetKernels();
+			if (level < CPU_LEVEL_SCALAR || level > s_supportedLevel)
+				return XN_STATUS_BAD_PARAM;
+
+			s_level = level;
+			ApplySelection();
+			return XN_STATUS_OK;
+		}
+
+		bool CpuDispatch::IsVerifying()
+		{
+			GetKernels();
+			return s_bVerify;
+		}
+
+		void CpuDispatch::SetVerifying(bool bVerify)
+		{
+			GetKernels();
+			s_bVerify = bVerify;
+			ApplySelection();
+		}
+
+		XnUInt32 CpuDispatch::GetMismatchCount(CpuKernel kernel)
+		{
+			if (kernel < 0 || kernel >= CPU_KERNEL_COUNT)
+				return 0;
+			return (XnUInt32)s_mismatches[kernel];
+		}
+
+		XnUInt32 CpuDispatch::GetTotalMismatchCount()
+		{
+			XnUInt32 nTotal = 0;
+			for (int i = 0; i < CPU_KERNEL_COUNT; ++i)
+				nTotal += (XnUInt32)s_mismatches[i];
+			return nTotal;
+		}
+
+		void CpuDispatch::ResetMismatches()
+		{
+			for (int i = 0; i < CPU_KERNEL_COUNT; ++i)
+				InterlockedExchange(&s_mismatches[i], 0);
+		}
+
+		const char* CpuDispatch::GetKernelName(CpuKernel kernel)
+		{
+			return (kernel >= 0 && kernel < CPU_KERNEL_COUNT) ? s_kernelNames[kernel] : "";
+		}
+
+		const char* CpuDispatch::GetLevelName(CpuLevel level)
+		{
+			return (level >= 0 && level < CPU_LEVEL_COUNT) ? s_levelNames[level] : "";
+		}
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <XnOS.h>
+#include "Geometry.h"
+
+// AVX2 intrinsics need Visual C++ 2012 or later; older compilers ship the SSSE3 level as the widest
+#if (defined(_MSC_VER) && _MSC_VER >= 1700) || defined(__AVX2__)
+#define MANAGEDNITEEX_CPU_AVX2 1
+#endif
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Instruction set levels of the kernel implementations, each level implies the lower ones.
+		enum CpuLevel
+		{
+			CPU_LEVEL_SCALAR = 0,
+			CPU_LEVEL_SSE2 = 1,
+			CPU_LEVEL_SSSE3 = 2,
+			CPU_LEVEL_AVX2 = 3,
+			CPU_LEVEL_COUNT = 4
+		};
+
+		// Features reported by CPUID (and enabled by the OS for AVX state).
+		enum CpuFeature
+		{
+			CPU_FEATURE_SSE2 = 1,
+			CPU_FEATURE_SSE3 = 2,
+			CPU_FEATURE_SSSE3 = 4,
+			CPU_FEATURE_SSE41 = 8,
+			CPU_FEATURE_SSE42 = 16,
+			CPU_FEATURE_AVX = 32,
+			CPU_FEATURE_AVX2 = 64,
+			CPU_FEATURE_AVX512F = 128
+		};
+
+		enum CpuKernel
+		{
+			CPU_KERNEL_SPAN_CHANGED8 = 0,
+			CPU_KERNEL_SPAN_CHANGED16,
+			CPU_KERNEL_DEPTH_HISTOGRAM,
+			CPU_KERNEL_UNPROJECT_ROW,
+			CPU_KERNEL_RGB_TO_BGRA,
+			CPU_KERNEL_COUNT
+		};
+
+		// One implementation of every dispatched kernel.
+		struct CpuKernels
+		{
+			// True when any element differs from the previous one by more than the tolerance.
+			bool (*pSpanChanged8)(const XnUInt8* pCur, const XnUInt8* pPrev, XnUInt32 nCount, XnUInt32 nTolerance);
+			bool (*pSpanChanged16)(const XnUInt16* pCur, const XnUInt16* pPrev, XnUInt32 nCount, XnUInt32 nTolerance);
+
+			// Adds the depths in (0, nMaxDepth) to pHistogram. Returns the number of counted pixels.
+			XnUInt32 (*pDepthHistogram)(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32* pHistogram, XnUInt32 nMaxDepth);
+
+			// Camera space xyz triples of one depth row (mm); pixels without depth become zero vectors.
+			void (*pUnprojectRow)(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32 nRow, const DepthIntrinsics& intrinsics, float* pXyz);
+
+			// RGB24 to BGRA32 with opaque alpha.
+			void (*pRgbToBgra)(const XnUInt8* pRgb, XnUInt32 nCount, XnUInt8* pBgra);
+		};
+
+		// Selects the kernel implementations for the CPU once when the library loads.
+		// The level can be forced with the MANAGEDNITEEX_CPU_LEVEL environment variable
+		// (scalar, sse2, ssse3, avx2) and MANAGEDNITEEX_CPU_VERIFY=1 runs the scalar
+		// reference next to every call and counts the calls with different results.
+		class CpuDispatch
+		{
+		public:
+			static const CpuKernels& GetKernels();
+
+			static XnUInt32 GetFeatures();
+			static CpuLevel GetSupportedLevel();
+			static CpuLevel GetLevel();
+			// Fails for levels the CPU or the compiler does not support.
+			static XnStatus SetLevel(CpuLevel level);
+
+			static bool IsVerifying();
+			static void SetVerifying(bool bVerify);
+
+			static XnUInt32 GetMismatchCount(CpuKernel kernel);
+			static XnUInt32 GetTotalMismatchCount();
+			static void ResetMismatches();
+
+			static const char* GetKernelName(CpuKernel kernel);
+			static const char* GetLevelName(CpuLevel level);
+		};
+	}
+}
@@ -0,0 +1,269 @@
+// Native (non /clr) translation unit - SSE2 and SSSE3 intrinsics.
+// The AVX2 level lives in CpuKernelsAvx2.cpp; only CpuDispatch decides which one may run.
+
+#include "CpuKernels.h"
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		//---------------------------------------------------------------------------
+		// Scalar reference
+		//---------------------------------------------------------------------------
+
+		static bool SpanChanged8Scalar(const XnUInt8* pCur, const XnUInt8* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			for (XnUInt32 i = 0; i < nCount; ++i)
+			{
+				int diff = (int)pCur[i] - (int)pPrev[i];
+				if ((XnUInt32)(diff < 0 ? -diff : diff) > nTolerance)
+					return true;
+			}
+			return false;
+		}
+
+		static bool SpanChanged16Scalar(const XnUInt16* pCur, const XnUInt16* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			for (XnUInt32 i = 0; i < nCount; ++i)
+			{
+				int diff = (int)pCur[i] - (int)pPrev[i];
+				if ((XnUInt32)(diff < 0 ? -diff : diff) > nTolerance)
+					return true;
+			}
+			return false;
+		}
+
+		static XnUInt32 DepthHistogramScalar(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32* pHistogram, XnUInt32 nMaxDepth)
+		{
+			XnUInt32 nPoints = 0;
+			for (XnUInt32 i = 0; i < nCount; ++i)
+			{
+				XnUInt16 d = pDepth[i];
+				if (d != 0 && d < nMaxDepth)
+				{
+					pHistogram[d]++;
+					nPoints++;
+				}
+			}
+			return nPoints;
+		}
+
+		void UnprojectSpan(const XnUInt16* pDepth, XnUInt32 nFirst, XnUInt32 nCount, XnUInt32 nRow, const DepthIntrinsics& intrinsics, float* pXyz)
+		{
+			for (XnUInt32 x = nFirst; x < nCount; ++x)
+			{
+				float* pOut = pXyz + x * 3;
+				if (pDepth[x] == 0)
+				{
+					pOut[0] = pOut[1] = pOut[2] = 0.0f;
+					continue;
+				}
+
+				Vector3f v = intrinsics.Unproject((float)x, (float)nRow, pDepth[x]);
+				pOut[0] = v.x;
+				pOut[1] = v.y;
+				pOut[2] = v.z;
+			}
+		}
+
+		static void UnprojectRowScalar(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32 nRow, const DepthIntrinsics& intrinsics, float* pXyz)
+		{
+			UnprojectSpan(pDepth, 0, nCount, nRow, intrinsics, pXyz);
+		}
+
+		static void RgbToBgraScalar(const XnUInt8* pRgb, XnUInt32 nCount, XnUInt8* pBgra)
+		{
+			for (XnUInt32 i = 0; i < nCount; ++i, pRgb += 3, pBgra += 4)
+			{
+				pBgra[0] = pRgb[2];
+				pBgra[1] = pRgb[1];
+				pBgra[2] = pRgb[0];
+				pBgra[3] = 0xFF;
+			}
+		}
+
+		//---------------------------------------------------------------------------
+		// SSE2
+		//---------------------------------------------------------------------------
+
+		static bool SpanChanged8Sse2(const XnUInt8* pCur, const XnUInt8* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			if (nTolerance >= 0xFF)
+				return false;
+
+			// |a - b| > t  <=>  saturate(|a - b| - t) != 0
+			const __m128i tolerance = _mm_set1_epi8((char)nTolerance);
+			const __m128i zero = _mm_setzero_si128();
+			XnUInt32 i = 0;
+			for (; i + 16 <= nCount; i += 16)
+			{
+				__m128i a = _mm_loadu_si128((const __m128i*)(pCur + i));
+				__m128i b = _mm_loadu_si128((const __m128i*)(pPrev + i));
+				__m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+				__m128i over = _mm_subs_epu8(diff, tolerance);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(over, zero)) != 0xFFFF)
+					return true;
+			}
+			return SpanChanged8Scalar(pCur + i, pPrev + i, nCount - i, nTolerance);
+		}
+
+		static bool SpanChanged16Sse2(const XnUInt16* pCur, const XnUInt16* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			if (nTolerance >= 0xFFFF)
+				return false;
+
+			const __m128i tolerance = _mm_set1_epi16((short)nTolerance);
+			const __m128i zero = _mm_setzero_si128();
+			XnUInt32 i = 0;
+			for (; i + 8 <= nCount; i += 8)
+			{
+				__m128i a = _mm_loadu_si128((const __m128i*)(pCur + i));
+				__m128i b = _mm_loadu_si128((const __m128i*)(pPrev + i));
+				__m128i diff = _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+				__m128i over = _mm_subs_epu16(diff, tolerance);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi16(over, zero)) != 0xFFFF)
+					return true;
+			}
+			return SpanChanged16Scalar(pCur + i, pPrev + i, nCount - i, nTolerance);
+		}
+
+		// The scatter into the histogram stays scalar; the vector part tests eight pixels at
+		// once so runs of missing or out of range depth cost a single compare.
+		static XnUInt32 DepthHistogramSse2(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32* pHistogram, XnUInt32 nMaxDepth)
+		{
+			if (nMaxDepth == 0)
+				return 0;
+			if (nMaxDepth > 0x10000)
+				nMaxDepth = 0x10000;
+
+			// 0 < d < max  <=>  (d - 1) < (max - 1) unsigned, compared signed after flipping the sign bit
+			const __m128i one = _mm_set1_epi16(1);
+			const __m128i bias = _mm_set1_epi16((short)0x8000);
+			const __m128i limit = _mm_set1_epi16((short)((nMaxDepth - 1) ^ 0x8000));
+
+			XnUInt32 nPoints = 0;
+			XnUInt32 i = 0;
+			for (; i + 8 <= nCount; i += 8)
+			{
+				__m128i d = _mm_loadu_si128((const __m128i*)(pDepth + i));
+				__m128i valid = _mm_cmplt_epi16(_mm_xor_si128(_mm_sub_epi16(d, one), bias), limit);
+				int nMask = _mm_movemask_epi8(valid);
+				if (nMask == 0)
+					continue;
+
+				const XnUInt16* p = pDepth + i;
+				if (nMask == 0xFFFF)
+				{
+					pHistogram[p[0]]++; pHistogram[p[1]]++; pHistogram[p[2]]++; pHistogram[p[3]]++;
+					pHistogram[p[4]]++; pHistogram[p[5]]++; pHistogram[p[6]]++; pHistogram[p[7]]++;
+					nPoints += 8;
+					continue;
+				}
+
+				for (int k = 0; k < 8; ++k)
+				{
+					if (nMask & (1 << (k * 2)))
+					{
+						pHistogram[p[k]]++;
+						nPoints++;
+					}
+				}
+			}
+			return nPoints + DepthHistogramScalar(pDepth + i, nCount - i, pHistogram, nMaxDepth);
+		}
+
+		// Same operation order as DepthIntrinsics::Unproject, so the results are bit identical.
+		static inline void UnprojectQuad(__m128 z, __m128 u, __m128 fRowY, const DepthIntrinsics& intrinsics, float* pXyz)
+		{
+			const __m128 valid = _mm_cmpneq_ps(z, _mm_setzero_ps());
+			__m128 x = _mm_div_ps(_mm_mul_ps(_mm_sub_ps(u, _mm_set1_ps(intrinsics.cx)), z), _mm_set1_ps(intrinsics.fx));
+			__m128 y = _mm_div_ps(_mm_mul_ps(fRowY, z), _mm_set1_ps(intrinsics.fy));
+			x = _mm_and_ps(x, valid);
+			y = _mm_and_ps(y, valid);
+			__m128 w = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			// the fourth lane of each store is overwritten by the next point
+			_mm_storeu_ps(pXyz, x);
+			_mm_storeu_ps(pXyz + 3, y);
+			_mm_storeu_ps(pXyz + 6, z);
+			_mm_storeu_ps(pXyz + 9, w);
+		}
+
+		static void UnprojectRowSse2(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32 nRow, const DepthIntrinsics& intrinsics, float* pXyz)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 fRowY = _mm_set1_ps((float)nRow - intrinsics.cy);
+			const __m128 step = _mm_set1_ps(4.0f);
+			__m128 u = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+			// stop one point early so the overlapping stores never run past the row
+			XnUInt32 x = 0;
+			for (; x + 8 < nCount; x += 8)
+			{
+				__m128i d = _mm_loadu_si128((const __m128i*)(pDepth + x));
+				__m128 zLo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(d, zero));
+				__m128 zHi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(d, zero));
+
+				UnprojectQuad(zLo, u, fRowY, intrinsics, pXyz + x * 3);
+				u = _mm_add_ps(u, step);
+				UnprojectQuad(zHi, u, fRowY, intrinsics, pXyz + x * 3 + 12);
+				u = _mm_add_ps(u, step);
+			}
+
+			UnprojectSpan(pDepth, x, nCount, nRow, intrinsics, pXyz);
+		}
+
+		//---------------------------------------------------------------------------
+		// SSSE3
+		//---------------------------------------------------------------------------
+
+		static void RgbToBgraSsse3(const XnUInt8* pRgb, XnUInt32 nCount, XnUInt8* pBgra)
+		{
+			const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+			const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+			// four pixels per step, each 16 byte load reads 12 bytes of them
+			XnUInt32 i = 0;
+			for (; (i + 4) * 3 + 4 <= nCount * 3; i += 4)
+			{
+				__m128i rgb = _mm_loadu_si128((const __m128i*)(pRgb + i * 3));
+				_mm_storeu_si128((__m128i*)(pBgra + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+			}
+			RgbToBgraScalar(pRgb + i * 3, nCount - i, pBgra + i * 4);
+		}
+
+		//---------------------------------------------------------------------------
+		// Tables
+		//---------------------------------------------------------------------------
+
+		const CpuKernels& GetScalarKernels()
+		{
+			static const CpuKernels kernels =
+			{
+				SpanChanged8Scalar, SpanChanged16Scalar, DepthHistogramScalar, UnprojectRowScalar, RgbToBgraScalar
+			};
+			return kernels;
+		}
+
+		const CpuKernels& GetSse2Kernels()
+		{
+			static const CpuKernels kernels =
+			{
+				SpanChanged8Sse2, SpanChanged16Sse2, DepthHistogramSse2, UnprojectRowSse2, RgbToBgraScalar
+			};
+			return kernels;
+		}
+
+		const CpuKernels& GetSsse3Kernels()
+		{
+			static const CpuKernels kernels =
+			{
+				SpanChanged8Sse2, SpanChanged16Sse2, DepthHistogramSse2, UnprojectRowSse2, RgbToBgraSsse3
+			};
+			return kernels;
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CpuDispatch.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Kernel tables of every level compiled into the library. The scalar table is the
+		// reference the vector levels are verified against. Used by CpuDispatch only.
+		const CpuKernels& GetScalarKernels();
+		const CpuKernels& GetSse2Kernels();
+		const CpuKernels& GetSsse3Kernels();
+#ifdef MANAGEDNITEEX_CPU_AVX2
+		// In CpuKernelsAvx2.cpp, built with /arch:AVX.
+		const CpuKernels& GetAvx2Kernels();
+#endif
+
+		// Scalar unprojection of the pixels [nFirst, nCount) of a row, the tail of the vector kernels.
+		void UnprojectSpan(const XnUInt16* pDepth, XnUInt32 nFirst, XnUInt32 nCount, XnUInt32 nRow, const DepthIntrinsics& intrinsics, float* pXyz);
+	}
+}
@@ -0,0 +1,182 @@
+// Native (non /clr) translation unit - AVX2 intrinsics.
+// Built with /arch:AVX so the 128-bit operations next to the 256-bit ones are VEX encoded
+// too; mixing them with legacy SSE encodings stalls on every transition. Only CpuDispatch
+// decides whether this level may run.
+
+#include "CpuKernels.h"
+
+#ifdef MANAGEDNITEEX_CPU_AVX2
+#include <immintrin.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		//---------------------------------------------------------------------------
+		// AVX2 - every function ends with vzeroupper before it returns or calls the SSE2 tail
+		//---------------------------------------------------------------------------
+
+		static bool SpanChanged8Avx2(const XnUInt8* pCur, const XnUInt8* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			if (nTolerance >= 0xFF)
+				return false;
+
+			const __m256i tolerance = _mm256_set1_epi8((char)nTolerance);
+			const __m256i zero = _mm256_setzero_si256();
+			XnUInt32 i = 0;
+			for (; i + 32 <= nCount; i += 32)
+			{
+				__m256i a = _mm256_loadu_si256((const __m256i*)(pCur + i));
+				__m256i b = _mm256_loadu_si256((const __m256i*)(pPrev + i));
+				__m256i diff = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+				__m256i over = _mm256_subs_epu8(diff, tolerance);
+				if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(over, zero)) != -1)
+				{
+					_mm256_zeroupper();
+					return true;
+				}
+			}
+			_mm256_zeroupper();
+			return GetSse2Kernels().pSpanChanged8(pCur + i, pPrev + i, nCount - i, nTolerance);
+		}
+
+		static bool SpanChanged16Avx2(const XnUInt16* pCur, const XnUInt16* pPrev, XnUInt32 nCount, XnUInt32 nTolerance)
+		{
+			if (nTolerance >= 0xFFFF)
+				return false;
+
+			const __m256i tolerance = _mm256_set1_epi16((short)nTolerance);
+			const __m256i zero = _mm256_setzero_si256();
+			XnUInt32 i = 0;
+			for (; i + 16 <= nCount; i += 16)
+			{
+				__m256i a = _mm256_loadu_si256((const __m256i*)(pCur + i));
+				__m256i b = _mm256_loadu_si256((const __m256i*)(pPrev + i));
+				__m256i diff = _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a));
+				__m256i over = _mm256_subs_epu16(diff, tolerance);
+				if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(over, zero)) != -1)
+				{
+					_mm256_zeroupper();
+					return true;
+				}
+			}
+			_mm256_zeroupper();
+			return GetSse2Kernels().pSpanChanged16(pCur + i, pPrev + i, nCount - i, nTolerance);
+		}
+
+		static XnUInt32 DepthHistogramAvx2(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32* pHistogram, XnUInt32 nMaxDepth)
+		{
+			if (nMaxDepth == 0)
+				return 0;
+			if (nMaxDepth > 0x10000)
+				nMaxDepth = 0x10000;
+
+			const __m256i one = _mm256_set1_epi16(1);
+			const __m256i bias = _mm256_set1_epi16((short)0x8000);
+			const __m256i limit = _mm256_set1_epi16((short)((nMaxDepth - 1) ^ 0x8000));
+
+			XnUInt32 nPoints = 0;
+			XnUInt32 i = 0;
+			for (; i + 16 <= nCount; i += 16)
+			{
+				__m256i d = _mm256_loadu_si256((const __m256i*)(pDepth + i));
+				__m256i valid = _mm256_cmpgt_epi16(limit, _mm256_xor_si256(_mm256_sub_epi16(d, one), bias));
+				XnUInt32 nMask = (XnUInt32)_mm256_movemask_epi8(valid);
+				if (nMask == 0)
+					continue;
+
+				const XnUInt16* p = pDepth + i;
+				if (nMask == 0xFFFFFFFF)
+				{
+					for (int k = 0; k < 16; ++k)
+						pHistogram[p[k]]++;
+					nPoints += 16;
+					continue;
+				}
+
+				for (int k = 0; k < 16; ++k)
+				{
+					if (nMask & (1u << (k * 2)))
+					{
+						pHistogram[p[k]]++;
+						nPoints++;
+					}
+				}
+			}
+			_mm256_zeroupper();
+			return nPoints + GetSse2Kernels().pDepthHistogram(pDepth + i, nCount - i, pHistogram, nMaxDepth);
+		}
+
+		static void UnprojectRowAvx2(const XnUInt16* pDepth, XnUInt32 nCount, XnUInt32 nRow, const DepthIntrinsics& intrinsics, float* pXyz)
+		{
+			const __m256 cx = _mm256_set1_ps(intrinsics.cx);
+			const __m256 fx = _mm256_set1_ps(intrinsics.fx);
+			const __m256 fy = _mm256_set1_ps(intrinsics.fy);
+			const __m256 fRowY = _mm256_set1_ps((float)nRow - intrinsics.cy);
+			const __m256 step = _mm256_set1_ps(8.0f);
+			__m256 u = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+			XnUInt32 x = 0;
+			for (; x + 8 < nCount; x += 8)
+			{
+				__m256 z = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(pDepth + x))));
+				__m256 valid = _mm256_cmp_ps(z, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+				__m256 vx = _mm256_and_ps(_mm256_div_ps(_mm256_mul_ps(_mm256_sub_ps(u, cx), z), fx), valid);
+				__m256 vy = _mm256_and_ps(_mm256_div_ps(_mm256_mul_ps(fRowY, z), fy), valid);
+				u = _mm256_add_ps(u, step);
+
+				// interleave both halves like the SSE2 kernel
+				float* pOut = pXyz + x * 3;
+				for (int h = 0; h < 2; ++h)
+				{
+					__m128 qx = h ? _mm256_extractf128_ps(vx, 1) : _mm256_castps256_ps128(vx);
+					__m128 qy = h ? _mm256_extractf128_ps(vy, 1) : _mm256_castps256_ps128(vy);
+					__m128 qz = h ? _mm256_extractf128_ps(z, 1) : _mm256_castps256_ps128(z);
+					__m128 qw = _mm_setzero_ps();
+					_MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+					_mm_storeu_ps(pOut, qx);
+					_mm_storeu_ps(pOut + 3, qy);
+					_mm_storeu_ps(pOut + 6, qz);
+					_mm_storeu_ps(pOut + 9, qw);
+					pOut += 12;
+				}
+			}
+			_mm256_zeroupper();
+			UnprojectSpan(pDepth, x, nCount, nRow, intrinsics, pXyz);
+		}
+
+		static void RgbToBgraAvx2(const XnUInt8* pRgb, XnUInt32 nCount, XnUInt8* pBgra)
+		{
+			const __m256i shuffle = _mm256_setr_epi8(
+				2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+				2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+			const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+			// eight pixels per step from two 16 byte loads, 12 bytes apart
+			XnUInt32 i = 0;
+			for (; (i + 8) * 3 + 4 <= nCount * 3; i += 8)
+			{
+				__m128i lo = _mm_loadu_si128((const __m128i*)(pRgb + i * 3));
+				__m128i hi = _mm_loadu_si128((const __m128i*)(pRgb + i * 3 + 12));
+				__m256i rgb = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+				_mm256_storeu_si256((__m256i*)(pBgra + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha));
+			}
+			_mm256_zeroupper();
+			GetScalarKernels().pRgbToBgra(pRgb + i * 3, nCount - i, pBgra + i * 4);
+		}
+
+		//---------------------------------------------------------------------------
+		// Table
+		//---------------------------------------------------------------------------
+
+		const CpuKernels& GetAvx2Kernels()
+		{
+			static const CpuKernels kernels =
+			{
+				SpanChanged8Avx2, SpanChanged16Avx2, DepthHistogramAvx2, UnprojectRowAvx2, RgbToBgraAvx2
+			};
+			return kernels;
+		}
+	}
+}
+#endif
@@ -0,0 +1,438 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "FrameProducts.h"
+#include "CpuDispatch.h"
+#include <windows.h>
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// depth steps above this between neighbours are treated as discontinuities (mm)
+		static const float NORMAL_MAX_DEPTH_STEP = 60.0f;
+
+		// rows per label statistics partial
+		static const XnUInt32 STATS_CHUNK_ROWS = 32;
+
+		struct LabelAccumulator
+		{
+			XnUInt32 nPixels;
+			XnUInt32 nDepthPixels;
+			XnUInt64 nSumX;
+			XnUInt64 nSumY;
+			XnUInt64 nSumDepth;
+			XnUInt32 nMinX;
+			XnUInt32 nMinY;
+			XnUInt32 nMaxX;
+			XnUInt32 nMaxY;
+		};
+
+		FrameProducts::FrameProducts(FrameProductsPool* pPool)
+			: m_pPool(pPool), m_nRefs(0), m_pLocks(new Concurrency::critical_section[PRODUCT_COUNT]),
+			  m_nFrameID(0), m_nTimestamp(0), m_nXRes(0), m_nYRes(0),
+			  m_bDepth(false), m_bImage(false), m_bLabels(false), m_nHistogramPoints(0)
+		{
+			for (int i = 0; i < PRODUCT_COUNT; ++i)
+				m_states[i] = STATE_EMPTY;
+		}
+
+		FrameProducts::~FrameProducts()
+		{
+			delete[] (Concurrency::critical_section*)m_pLocks;
+		}
+
+		void FrameProducts::Bind(const FrameSource& source)
+		{
+			m_nFrameID = source.nFrameID;
+			m_nTimestamp = source.nTimestamp;
+			m_nXRes = source.nXRes;
+			m_nYRes = source.nYRes;
+			m_intrinsics = source.intrinsics;
+
+			// buffers keep their capacity, so frames of the same resolution do not allocate
+			const size_t nPixels = (size_t)m_nXRes * m_nYRes;
+			m_bDepth = source.pDepth != NULL && nPixels != 0;
+			m_bImage = source.pImage != NULL && nPixels != 0;
+			m_bLabels = source.pLabels != NULL && nPixels != 0;
+
+			if (m_bDepth)
+				m_depth.assign(source.pDepth, source.pDepth + nPixels);
+			if (m_bImage)
+				m_image.assign(source.pImage, source.pImage + nPixels * 3);
+			if (m_bLabels)
+				m_labels.assign(source.pLabels, source.pLabels + nPixels);
+			else
+				m_labelStats.clear();
+
+			for (int i = 0; i < PRODUCT_COUNT; ++i)
+				m_states[i] = STATE_EMPTY;
+			m_nRefs = 1;
+		}
+
+		void FrameProducts::AddRef()
+		{
+			InterlockedIncrement(&m_nRefs);
+		}
+
+		void FrameProducts::Release()
+		{
+			if (InterlockedDecrement(&m_nRefs) == 0)
+			{
+				m_pPool->Recycle(this);
+			}
+		}
+
+		void FrameProducts::Ensure(Product product)
+		{
+			// double-checked: ready products are read without taking the lock
+			if (m_states[product] == STATE_READY)
+			{
+				MemoryBarrier();
+				return;
+			}
+
+			Concurrency::critical_section& lock = ((Concurrency::critical_section*)m_pLocks)[product];
+			Concurrency::critical_section::scoped_lock guard(lock);
+			if (m_states[product] != STATE_READY)
+			{
+				Compute(product);
+				MemoryBarrier();
+				m_states[product] = STATE_READY;
+			}
+		}
+
+		void FrameProducts::Compute(Product product)
+		{
+			switch (product)
+			{
+			case PRODUCT_HISTOGRAM:
+				ComputeHistogram();
+				break;
+			case PRODUCT_POINTS:
+				ComputePoints();
+				break;
+			case PRODUCT_NORMALS:
+				ComputeNormals();
+				break;
+			case PRODUCT_BGRA:
+				ComputeBgra();
+				break;
+			case PRODUCT_LABEL_STATS:
+				ComputeLabelStats();
+				break;
+			default:
+				break;
+			}
+		}
+
+		const XnUInt32* FrameProducts::GetHistogram()
+		{
+			if (!m_bDepth)
+				return NULL;
+			Ensure(PRODUCT_HISTOGRAM);
+			return &m_histogram[0];
+		}
+
+		XnUInt32 FrameProducts::GetHistogramPoints()
+		{
+			if (!m_bDepth)
+				return 0;
+			Ensure(PRODUCT_HISTOGRAM);
+			return m_nHistogramPoints;
+		}
+
+		const float* FrameProducts::GetPoints()
+		{
+			if (!m_bDepth)
+				return NULL;
+			Ensure(PRODUCT_POINTS);
+			return &m_points[0];
+		}
+
+		const float* FrameProducts::GetNormals()
+		{
+			if (!m_bDepth)
+				return NULL;
+			Ensure(PRODUCT_NORMALS);
+			return &m_normals[0];
+		}
+
+		const XnUInt8* FrameProducts::GetBgra()
+		{
+			if (!m_bImage)
+				return NULL;
+			Ensure(PRODUCT_BGRA);
+			return &m_bgra[0];
+		}
+
+		const std::vector<FrameProducts::LabelStats>& FrameProducts::GetLabelStats()
+		{
+			// without a label map the stats stay empty (cleared by Bind)
+			if (!m_bLabels)
+				return m_labelStats;
+			Ensure(PRODUCT_LABEL_STATS);
+			return m_labelStats;
+		}
+
+		void FrameProducts::ComputeHistogram()
+		{
+			m_histogram.assign(MAX_DEPTH, 0);
+			m_nHistogramPoints = CpuDispatch::GetKernels().pDepthHistogram(&m_depth[0], m_nXRes * m_nYRes, &m_histogram[0], MAX_DEPTH);
+		}
+
+		void FrameProducts::ComputePoints()
+		{
+			m_points.resize((size_t)m_nXRes * m_nYRes * 3);
+
+			const CpuKernels& kernels = CpuDispatch::GetKernels();
+			const XnUInt32 nXRes = m_nXRes;
+			const XnUInt16* pDepth = &m_depth[0];
+			float* pPoints = &m_points[0];
+			const DepthIntrinsics& intrinsics = m_intrinsics;
+
+			Concurrency::parallel_for(0, (int)m_nYRes, [&](int y)
+			{
+				const XnUInt16* pRow = pDepth + y * nXRes;
+				float* pOut = pPoints + (size_t)y * nXRes * 3;
+				kernels.pUnprojectRow(pRow, nXRes, (XnUInt32)y, intrinsics, pOut);
+
+				// camera space has y down, real world y up
+				for (XnUInt32 x = 0; x < nXRes; ++x)
+				{
+					if (pRow[x] != 0)
+						pOut[x * 3 + 1] = -pOut[x * 3 + 1];
+				}
+			});
+		}
+
+		void FrameProducts::ComputeNormals()
+		{
+			const float* pPoints = GetPoints();
+			m_normals.resize((size_t)m_nXRes * m_nYRes * 3);
+
+			const XnUInt32 nXRes = m_nXRes;
+			const XnUInt32 nYRes = m_nYRes;
+			float* pNormals = &m_normals[0];
+
+			Concurrency::parallel_for(0, (int)nYRes, [&](int y)
+			{
+				float* pOut = pNormals + (size_t)y * nXRes * 3;
+				for (XnUInt32 x = 0; x < nXRes; ++x, pOut += 3)
+				{
+					pOut[0] = pOut[1] = pOut[2] = 0.0f;
+					if (x + 1 >= nXRes || (XnUInt32)y + 1 >= nYRes)
+						continue;
+
+					const float* p = pPoints + ((size_t)y * nXRes + x) * 3;
+					const float* px = p + 3;
+					const float* py = p + nXRes * 3;
+					if (p[2] == 0.0f || px[2] == 0.0f || py[2] == 0.0f)
+						continue;
+					if (fabsf(px[2] - p[2]) > NORMAL_MAX_DEPTH_STEP || fabsf(py[2] - p[2]) > NORMAL_MAX_DEPTH_STEP)
+						continue;
+
+					Vector3f v = MakeVector3f(p[0], p[1], p[2]);
+					Vector3f n = Normalize(Cross(MakeVector3f(px[0], px[1], px[2]) - v, MakeVector3f(py[0], py[1], py[2]) - v));
+
+					// the camera sits at the origin
+					if (Dot(n, v) > 0.0f)
+						n = n * -1.0f;
+
+					pOut[0] = n.x;
+					pOut[1] = n.y;
+					pOut[2] = n.z;
+				}
+			});
+		}
+
+		void FrameProducts::ComputeBgra()
+		{
+			m_bgra.resize((size_t)m_nXRes * m_nYRes * 4);
+
+			const CpuKernels& kernels = CpuDispatch::GetKernels();
+			const XnUInt32 nXRes = m_nXRes;
+			const XnUInt8* pImage = &m_image[0];
+			XnUInt8* pBgra = &m_bgra[0];
+
+			Concurrency::parallel_for(0, (int)m_nYRes, [&](int y)
+			{
+				kernels.pRgbToBgra(pImage + (size_t)y * nXRes * 3, nXRes, pBgra + (size_t)y * nXRes * 4);
+			});
+		}
+
+		void FrameProducts::ComputeLabelStats()
+		{
+			m_labelStats.clear();
+
+			const XnUInt32 nXRes = m_nXRes;
+			const XnUInt32 nYRes = m_nYRes;
+			const XnUInt16* pLabels = &m_labels[0];
+			const XnUInt16* pDepth = m_bDepth ? &m_depth[0] : NULL;
+
+			// partial sums per band of rows, indexed by label and grown on demand
+			const XnUInt32 nChunks = (nYRes + STATS_CHUNK_ROWS - 1) / STATS_CHUNK_ROWS;
+			std::vector<std::vector<LabelAccumulator> > partials(nChunks);
+
+			Concurrency::parallel_for(0, (int)nChunks, [&](int c)
+			{
+				std::vector<LabelAccumulator>& acc = partials[c];
+				XnUInt32 nFirstRow = c * STATS_CHUNK_ROWS;
+				XnUInt32 nLastRow = (nFirstRow + STATS_CHUNK_ROWS < nYRes) ? nFirstRow + STATS_CHUNK_ROWS : nYRes;
+
+				for (XnUInt32 y = nFirstRow; y < nLastRow; ++y)
+				{
+					const XnUInt16* pRow = pLabels + y * nXRes;
+					for (XnUInt32 x = 0; x < nXRes; ++x)
+					{
+						XnUInt16 nLabel = pRow[x];
+						if (nLabel == 0)
+							continue;
+
+						if (nLabel >= acc.size())
+						{
+							LabelAccumulator empty = { 0, 0, 0, 0, 0, 0xFFFFFFFF, 0xFFFFFFFF, 0, 0 };
+							acc.resize(nLabel + 1, empty);
+						}
+
+						LabelAccumulator& a = acc[nLabel];
+						a.nPixels++;
+						a.nSumX += x;
+						a.nSumY += y;
+						if (x < a.nMinX) a.nMinX = x;
+						if (y < a.nMinY) a.nMinY = y;
+						if (x > a.nMaxX) a.nMaxX = x;
+						if (y > a.nMaxY) a.nMaxY = y;
+
+						if (pDepth != NULL && pDepth[y * nXRes + x] != 0)
+						{
+							a.nDepthPixels++;
+							a.nSumDepth += pDepth[y * nXRes + x];
+						}
+					}
+				}
+			});
+
+			size_t nLabels = 0;
+			for (XnUInt32 c = 0; c < nChunks; ++c)
+			{
+				if (partials[c].size() > nLabels)
+					nLabels = partials[c].size();
+			}
+
+			for (size_t l = 1; l < nLabels; ++l)
+			{
+				LabelAccumulator total = { 0, 0, 0, 0, 0, 0xFFFFFFFF, 0xFFFFFFFF, 0, 0 };
+				for (XnUInt32 c = 0; c < nChunks; ++c)
+				{
+					if (l >= partials[c].size() || partials[c][l].nPixels == 0)
+						continue;
+
+					const LabelAccumulator& a = partials[c][l];
+					total.nPixels += a.nPixels;
+					total.nDepthPixels += a.nDepthPixels;
+					total.nSumX += a.nSumX;
+					total.nSumY += a.nSumY;
+					total.nSumDepth += a.nSumDepth;
+					if (a.nMinX < total.nMinX) total.nMinX = a.nMinX;
+					if (a.nMinY < total.nMinY) total.nMinY = a.nMinY;
+					if (a.nMaxX > total.nMaxX) total.nMaxX = a.nMaxX;
+					if (a.nMaxY > total.nMaxY) total.nMaxY = a.nMaxY;
+				}
+
+				if (total.nPixels == 0)
+					continue;
+
+				LabelStats stats;
+				stats.nLabel = (XnUInt16)l;
+				stats.nPixels = total.nPixels;
+				stats.nMinX = total.nMinX;
+				stats.nMinY = total.nMinY;
+				stats.nMaxX = total.nMaxX;
+				stats.nMaxY = total.nMaxY;
+				stats.fCenterX = (float)((double)total.nSumX / total.nPixels);
+				stats.fCenterY = (float)((double)total.nSumY / total.nPixels);
+				stats.fMeanDepth = total.nDepthPixels == 0 ? 0.0f : (float)((double)total.nSumDepth / total.nDepthPixels);
+				stats.center = MakeVector3f(0, 0, 0);
+				if (stats.fMeanDepth > 0.0f)
+				{
+					Vector3f c = m_intrinsics.Unproject(stats.fCenterX, stats.fCenterY, stats.fMeanDepth);
+					stats.center = MakeVector3f(c.x, -c.y, c.z);
+				}
+				m_labelStats.push_back(stats);
+			}
+		}
+
+		//---------------------------------------------------------------------------
+		// Pool
+		//---------------------------------------------------------------------------
+
+		FrameProductsPool::FrameProductsPool(XnUInt32 nMaxFree)
+			: m_nMaxFree(nMaxFree), m_nRefs(1), m_nLive(0), m_pLock(new Concurrency::critical_section())
+		{
+		}
+
+		FrameProductsPool::~FrameProductsPool()
+		{
+			for (size_t i = 0; i < m_free.size(); ++i)
+				delete m_free[i];
+			delete (Concurrency::critical_section*)m_pLock;
+		}
+
+		void FrameProductsPool::AddRef()
+		{
+			InterlockedIncrement(&m_nRefs);
+		}
+
+		void FrameProductsPool::Release()
+		{
+			if (InterlockedDecrement(&m_nRefs) == 0)
+				delete this;
+		}
+
+		XnUInt32 FrameProductsPool::GetFreeCount() const
+		{
+			Concurrency::critical_section::scoped_lock guard(*(Concurrency::critical_section*)m_pLock);
+			return (XnUInt32)m_free.size();
+		}
+
+		FrameProducts* FrameProductsPool::Acquire(const FrameSource& source)
+		{
+			FrameProducts* pFrame = NULL;
+			{
+				Concurrency::critical_section::scoped_lock guard(*(Concurrency::critical_section*)m_pLock);
+				if (!m_free.empty())
+				{
+					pFrame = m_free.back();
+					m_free.pop_back();
+				}
+			}
+
+			if (pFrame == NULL)
+				pFrame = new FrameProducts(this);
+
+			// every live frame keeps the pool alive
+			AddRef();
+			InterlockedIncrement(&m_nLive);
+			pFrame->Bind(source);
+			return pFrame;
+		}
+
+		void FrameProductsPool::Recycle(FrameProducts* pFrame)
+		{
+			bool bKeep;
+			{
+				Concurrency::critical_section::scoped_lock guard(*(Concurrency::critical_section*)m_pLock);
+				bKeep = m_free.size() < m_nMaxFree;
+				if (bKeep)
+					m_free.push_back(pFrame);
+			}
+
+			if (!bKeep)
+				delete pFrame;
+
+			InterlockedDecrement(&m_nLive);
+			Release();
+		}
+	}
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <XnOS.h>
+#include <vector>
+#include "Geometry.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		class FrameProductsPool;
+
+		// Source maps of one frame set. Unused maps may be NULL; all maps share the resolution.
+		struct FrameSource
+		{
+			const XnUInt16* pDepth;
+			const XnUInt8* pImage;		// RGB24
+			const XnUInt16* pLabels;
+			XnUInt32 nXRes;
+			XnUInt32 nYRes;
+			XnUInt32 nFrameID;
+			XnUInt64 nTimestamp;
+			DepthIntrinsics intrinsics;
+		};
+
+		// Copies of the maps of one frame set and the products derived from them. Every
+		// product is computed by the first thread requesting it while concurrent requesters
+		// wait, and is kept until the last reference is released and the frame returns to
+		// its pool with all buffers allocated for the next frame.
+		class FrameProducts
+		{
+		public:
+			enum Product
+			{
+				PRODUCT_HISTOGRAM = 0,
+				PRODUCT_POINTS,
+				PRODUCT_NORMALS,
+				PRODUCT_BGRA,
+				PRODUCT_LABEL_STATS,
+				PRODUCT_COUNT
+			};
+
+			static const XnUInt32 MAX_DEPTH = 10000;
+
+			struct LabelStats
+			{
+				XnUInt16 nLabel;
+				XnUInt32 nPixels;
+				XnUInt32 nMinX;
+				XnUInt32 nMinY;
+				XnUInt32 nMaxX;
+				XnUInt32 nMaxY;
+				float fCenterX;			// projective center of mass
+				float fCenterY;
+				float fMeanDepth;		// over the pixels with depth, 0 without any
+				Vector3f center;		// real world center, zero without depth
+			};
+
+			XnUInt32 GetFrameID() const { return m_nFrameID; }
+			XnUInt64 GetTimestamp() const { return m_nTimestamp; }
+			XnUInt32 GetXRes() const { return m_nXRes; }
+			XnUInt32 GetYRes() const { return m_nYRes; }
+
+			bool HasDepth() const { return m_bDepth; }
+			bool HasImage() const { return m_bImage; }
+			bool HasLabels() const { return m_bLabels; }
+
+			const XnUInt16* GetDepth() const { return m_bDepth ? &m_depth[0] : NULL; }
+			const XnUInt8* GetImage() const { return m_bImage ? &m_image[0] : NULL; }
+			const XnUInt16* GetLabels() const { return m_bLabels ? &m_labels[0] : NULL; }
+
+			// Products return NULL (or no stats) when their source map is missing.
+
+			// MAX_DEPTH counts of the depths in (0, MAX_DEPTH).
+			const XnUInt32* GetHistogram();
+			XnUInt32 GetHistogramPoints();
+			// Real world xyz triples (mm, Y up) per pixel, zero vectors for pixels without depth.
+			const float* GetPoints();
+			// Unit normals per pixel facing the camera, zero vectors where undefined.
+			const float* GetNormals();
+			// BGRA32 copy of the image with opaque alpha.
+			const XnUInt8* GetBgra();
+			// Stats of every label present in the label map, ordered by label.
+			const std::vector<LabelStats>& GetLabelStats();
+
+			bool IsComputed(Product product) const { return m_states[product] == STATE_READY; }
+
+			void AddRef();
+			// Returns the frame to its pool when the last reference is released.
+			void Release();
+
+		private:
+			friend class FrameProductsPool;
+
+			enum State
+			{
+				STATE_EMPTY = 0,
+				STATE_READY = 1
+			};
+
+			FrameProducts(FrameProductsPool* pPool);
+			~FrameProducts();
+
+			void Bind(const FrameSource& source);
+			void Ensure(Product product);
+			void Compute(Product product);
+
+			void ComputeHistogram();
+			void ComputePoints();
+			void ComputeNormals();
+			void ComputeBgra();
+			void ComputeLabelStats();
+
+			FrameProductsPool* m_pPool;
+			volatile long m_nRefs;
+			volatile long m_states[PRODUCT_COUNT];
+			void* m_pLocks;
+
+			XnUInt32 m_nFrameID;
+			XnUInt64 m_nTimestamp;
+			XnUInt32 m_nXRes;
+			XnUInt32 m_nYRes;
+			DepthIntrinsics m_intrinsics;
+			bool m_bDepth;
+			bool m_bImage;
+			bool m_bLabels;
+
+			std::vector<XnUInt16> m_depth;
+			std::vector<XnUInt8> m_image;
+			std::vector<XnUInt16> m_labels;
+
+			std::vector<XnUInt32> m_histogram;
+			XnUInt32 m_nHistogramPoints;
+			std::vector<float> m_points;
+			std::vector<float> m_normals;
+			std::vector<XnUInt8> m_bgra;
+			std::vector<LabelStats> m_labelStats;
+		};
+
+		// Recycles frame products so their buffers are reused from frame to frame.
+		// The pool stays alive until its owner and every outstanding frame released it.
+		class FrameProductsPool
+		{
+		public:
+			// Keeps at most nMaxFree retired frames for reuse.
+			FrameProductsPool(XnUInt32 nMaxFree);
+
+			// Copies the source maps into a recycled (or new) frame holding one reference.
+			FrameProducts* Acquire(const FrameSource& source);
+
+			XnUInt32 GetMaxFree() const { return m_nMaxFree; }
+			XnUInt32 GetFreeCount() const;
+			// Frames acquired and not yet retired.
+			XnUInt32 GetLiveCount() const { return (XnUInt32)m_nLive; }
+
+			void AddRef();
+			void Release();
+
+		private:
+			friend class FrameProducts;
+
+			~FrameProductsPool();
+			void Recycle(FrameProducts* pFrame);
+
+			XnUInt32 m_nMaxFree;
+			volatile long m_nRefs;
+			volatile long m_nLive;
+			void* m_pLock;
+			std::vector<FrameProducts*> m_free;
+		};
+	}
+}
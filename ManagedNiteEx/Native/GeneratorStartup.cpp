@@ -0,0 +1,132 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "GeneratorStartup.h"
+#include <windows.h>
+#include <ppl.h>
+#include <map>
+#include <string>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Adds the indices of the listed generators the node needs, directly or through needed nodes 
+		// outside the list, and the first needed node outside the list (the device producing the data).
+		static void CollectDependencies(const xn::NodeInfo& info, const std::map<std::string, size_t>& indices, 
+			std::vector<size_t>& dependencies, std::string& strProducer)
+		{
+			xn::NodeInfoList& needed = info.GetNeededNodes();
+			for (xn::NodeInfoList::Iterator it = needed.Begin(); it != needed.End(); ++it)
+			{
+				xn::NodeInfo neededInfo = *it;
+				std::map<std::string, size_t>::const_iterator found = indices.find(neededInfo.GetInstanceName());
+				if (found != indices.end())
+					dependencies.push_back(found->second);
+				else
+				{
+					if (strProducer.empty())
+						strProducer = neededInfo.GetInstanceName();
+					CollectDependencies(neededInfo, indices, dependencies, strProducer);
+				}
+			}
+		}
+
+		XnStatus StartGeneratorsParallel(std::vector<xn::Generator>& generators, std::vector<GeneratorStartResult>& results)
+		{
+			results.resize(generators.size());
+			if (generators.empty())
+				return XN_STATUS_OK;
+
+			std::map<std::string, size_t> indices;
+			for (size_t i = 0; i < generators.size(); ++i)
+				indices[generators[i].GetName()] = i;
+
+			std::vector<std::vector<size_t> > dependencies(generators.size());
+			std::vector<std::string> producers(generators.size());
+			for (size_t i = 0; i < generators.size(); ++i)
+				CollectDependencies(generators[i].GetInfo(), indices, dependencies[i], producers[i]);
+
+			// stage of a generator: one past the latest stage of the generators it needs
+			std::vector<size_t> stages(generators.size(), 0);
+			size_t nStageCount = 1;
+			for (bool bChanged = true; bChanged; )
+			{
+				bChanged = false;
+				for (size_t i = 0; i < generators.size(); ++i)
+				{
+					for (size_t j = 0; j < dependencies[i].size(); ++j)
+					{
+						size_t nStage = stages[dependencies[i][j]] + 1;
+						// a stage beyond the generator count means a cycle, which the node graph does not allow
+						if (nStage > stages[i] && nStage < generators.size())
+						{
+							stages[i] = nStage;
+							bChanged = true;
+							if (nStage + 1 > nStageCount)
+								nStageCount = nStage + 1;
+						}
+					}
+				}
+			}
+
+			LARGE_INTEGER frequency;
+			QueryPerformanceFrequency(&frequency);
+
+			// Within a stage, generators of one device (depth, image and IR of a sensor) start one
+			// after the other since they configure the same hardware; only different devices
+			// and generators without one start concurrently.
+			std::vector<std::vector<size_t> > groups;
+			for (size_t nStage = 0; nStage < nStageCount; ++nStage)
+			{
+				groups.clear();
+				std::map<std::string, size_t> groupByProducer;
+				for (size_t i = 0; i < generators.size(); ++i)
+				{
+					if (stages[i] != nStage)
+						continue;
+
+					if (producers[i].empty())
+					{
+						groups.push_back(std::vector<size_t>(1, i));
+						continue;
+					}
+
+					std::map<std::string, size_t>::iterator found = groupByProducer.find(producers[i]);
+					if (found == groupByProducer.end())
+					{
+						groupByProducer[producers[i]] = groups.size();
+						groups.push_back(std::vector<size_t>(1, i));
+					}
+					else
+					{
+						groups[found->second].push_back(i);
+					}
+				}
+
+				Concurrency::parallel_for(0, (int)groups.size(), [&](int nGroup)
+				{
+					const std::vector<size_t>& group = groups[nGroup];
+					for (size_t j = 0; j < group.size(); ++j)
+					{
+						size_t i = group[j];
+						LARGE_INTEGER start, end;
+						QueryPerformanceCounter(&start);
+
+						xn::Generator& generator = generators[i];
+						results[i].nStatus = generator.IsGenerating() ? XN_STATUS_OK : generator.StartGenerating();
+
+						QueryPerformanceCounter(&end);
+						results[i].nDurationUs = (XnUInt64)((end.QuadPart - start.QuadPart) * 1000000 / frequency.QuadPart);
+					}
+				});
+			}
+
+			for (size_t i = 0; i < results.size(); ++i)
+			{
+				if (results[i].nStatus != XN_STATUS_OK)
+					return results[i].nStatus;
+			}
+			return XN_STATUS_OK;
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <XnOS.h>
+#include <XnCppWrapper.h>
+#include <vector>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		struct GeneratorStartResult
+		{
+			XnStatus nStatus;
+			XnUInt64 nDurationUs;
+		};
+
+		// Starts the given generators instead of the serial StartGeneratingAll. Generators 
+		// needing other generators of the list (user, scene and hands nodes start their depth
+		// node) wait for them. Generators of the same device start one after the other, so
+		// only generators of different devices start concurrently.
+		// Generators that already generate are skipped.
+		// Returns the first failure, results are filled per generator.
+		XnStatus StartGeneratorsParallel(std::vector<xn::Generator>& generators, std::vector<GeneratorStartResult>& results);
+	}
+}
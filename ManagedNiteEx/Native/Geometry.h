@@ -0,0 +1,151 @@
+#pragma once
+
+#include <XnOS.h>
+#include <math.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		struct Vector3f
+		{
+			float x;
+			float y;
+			float z;
+		};
+
+		inline Vector3f MakeVector3f(float x, float y, float z)
+		{
+			Vector3f v = { x, y, z };
+			return v;
+		}
+
+		inline Vector3f operator+(const Vector3f& a, const Vector3f& b) { return MakeVector3f(a.x + b.x, a.y + b.y, a.z + b.z); }
+		inline Vector3f operator-(const Vector3f& a, const Vector3f& b) { return MakeVector3f(a.x - b.x, a.y - b.y, a.z - b.z); }
+		inline Vector3f operator*(const Vector3f& a, float s) { return MakeVector3f(a.x * s, a.y * s, a.z * s); }
+
+		inline float Dot(const Vector3f& a, const Vector3f& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+		inline Vector3f Cross(const Vector3f& a, const Vector3f& b)
+		{
+			return MakeVector3f(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+		}
+
+		inline Vector3f Normalize(const Vector3f& v)
+		{
+			float len = sqrtf(Dot(v, v));
+			return (len > 0.0f) ? v * (1.0f / len) : v;
+		}
+
+		// Rigid transform stored as a row-major 3x4 matrix [R|t] applied to column vectors.
+		// Managed APIs exchange it as a row-major 4x4 array (translation in elements 3, 7 and 11).
+		struct RigidTransform
+		{
+			float m[12];
+
+			static RigidTransform Identity()
+			{
+				RigidTransform t = { { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0 } };
+				return t;
+			}
+
+			static RigidTransform FromMatrix4x4(const float* p)
+			{
+				RigidTransform t;
+				for (int i = 0; i < 12; ++i)
+					t.m[i] = p[i];
+				return t;
+			}
+
+			void ToMatrix4x4(float* p) const
+			{
+				for (int i = 0; i < 12; ++i)
+					p[i] = m[i];
+				p[12] = 0; p[13] = 0; p[14] = 0; p[15] = 1;
+			}
+
+			Vector3f Apply(const Vector3f& v) const
+			{
+				return MakeVector3f(
+					m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3],
+					m[4] * v.x + m[5] * v.y + m[6] * v.z + m[7],
+					m[8] * v.x + m[9] * v.y + m[10] * v.z + m[11]);
+			}
+
+			Vector3f Rotate(const Vector3f& v) const
+			{
+				return MakeVector3f(
+					m[0] * v.x + m[1] * v.y + m[2] * v.z,
+					m[4] * v.x + m[5] * v.y + m[6] * v.z,
+					m[8] * v.x + m[9] * v.y + m[10] * v.z);
+			}
+
+			Vector3f Translation() const
+			{
+				return MakeVector3f(m[3], m[7], m[11]);
+			}
+
+			RigidTransform Inverse() const
+			{
+				RigidTransform t;
+				// transpose of the rotation
+				t.m[0] = m[0]; t.m[1] = m[4]; t.m[2] = m[8];
+				t.m[4] = m[1]; t.m[5] = m[5]; t.m[6] = m[9];
+				t.m[8] = m[2]; t.m[9] = m[6]; t.m[10] = m[10];
+				Vector3f tr = t.Rotate(Translation());
+				t.m[3] = -tr.x; t.m[7] = -tr.y; t.m[11] = -tr.z;
+				return t;
+			}
+
+			// this * other (other is applied first)
+			RigidTransform Compose(const RigidTransform& o) const
+			{
+				RigidTransform t;
+				for (int r = 0; r < 3; ++r)
+				{
+					for (int c = 0; c < 3; ++c)
+					{
+						t.m[r * 4 + c] = m[r * 4] * o.m[c] + m[r * 4 + 1] * o.m[4 + c] + m[r * 4 + 2] * o.m[8 + c];
+					}
+					t.m[r * 4 + 3] = m[r * 4] * o.m[3] + m[r * 4 + 1] * o.m[7] + m[r * 4 + 2] * o.m[11] + m[r * 4 + 3];
+				}
+				return t;
+			}
+		};
+
+		// Pinhole model of the depth camera. Camera space is x right, y down, z forward (mm).
+		struct DepthIntrinsics
+		{
+			float fx;
+			float fy;
+			float cx;
+			float cy;
+
+			static DepthIntrinsics Create(float focalLength, float cx, float cy)
+			{
+				DepthIntrinsics in = { focalLength, focalLength, cx, cy };
+				return in;
+			}
+
+			// From the device's zero plane distance (ZPD, mm) and pixel size (ZPPS, mm at SXGA).
+			static DepthIntrinsics FromZeroPlane(XnUInt64 nZeroPlaneDistance, XnDouble fZeroPlanePixelSize, XnUInt32 nXRes, XnUInt32 nYRes)
+			{
+				// ZPPS refers to the 1280 pixel wide sensor
+				double pixelSize = fZeroPlanePixelSize * 1280.0 / nXRes;
+				float f = (float)(nZeroPlaneDistance / pixelSize);
+				return Create(f, nXRes * 0.5f, nYRes * 0.5f);
+			}
+
+			Vector3f Unproject(float u, float v, float z) const
+			{
+				return MakeVector3f((u - cx) * z / fx, (v - cy) * z / fy, z);
+			}
+
+			DepthIntrinsics Scaled(float scale) const
+			{
+				DepthIntrinsics in = { fx * scale, fy * scale, (cx + 0.5f) * scale - 0.5f, (cy + 0.5f) * scale - 0.5f };
+				return in;
+			}
+		};
+	}
+}
@@ -0,0 +1,104 @@
+// Native (non /clr) translation unit.
+
+#include "HandTracker.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		HandTracker::HandTracker(xn::HandsGenerator& generator, XnUInt32 nMaxHands)
+			: m_generator(generator), m_nMaxHands(nMaxHands), m_hCallbacks(NULL),
+			  m_hands(nMaxHands, HandPoint()), m_filter(nMaxHands, 1)
+		{
+		}
+
+		HandTracker::~HandTracker()
+		{
+			Detach();
+		}
+
+		XnStatus HandTracker::Attach()
+		{
+			if (m_hCallbacks != NULL)
+				return XN_STATUS_OK;
+
+			return m_generator.RegisterHandCallbacks(OnHandCreate, OnHandUpdate, OnHandDestroy, this, m_hCallbacks);
+		}
+
+		void HandTracker::Detach()
+		{
+			if (m_hCallbacks == NULL)
+				return;
+
+			m_generator.UnregisterHandCallbacks(m_hCallbacks);
+			m_hCallbacks = NULL;
+		}
+
+		XnUInt32 HandTracker::GetHands(HandPoint* pHands, XnUInt32 nMaxHands) const
+		{
+			JointFilter::ScopedLock guard(m_filter);
+			XnUInt32 nCount = 0;
+			for (XnUInt32 i = 0; i < m_nMaxHands && nCount < nMaxHands; ++i)
+			{
+				if (m_hands[i].nId != 0)
+					pHands[nCount++] = m_hands[i];
+			}
+			return nCount;
+		}
+
+		void HandTracker::Store(XnUserID nId, const XnPoint3D* pPosition, XnFloat fTime, bool bNew)
+		{
+			JointFilter::ScopedLock guard(m_filter);
+			XnUInt32 nSlot = m_nMaxHands;
+			for (XnUInt32 i = 0; i < m_nMaxHands; ++i)
+			{
+				if (m_hands[i].nId == nId)
+				{
+					nSlot = i;
+					break;
+				}
+				if (nSlot == m_nMaxHands && m_hands[i].nId == 0)
+					nSlot = i;
+			}
+			if (nSlot == m_nMaxHands)
+				return;
+
+			HandPoint& hand = m_hands[nSlot];
+			if (bNew || hand.nId != nId)
+				m_filter.ResetSlot(nSlot);
+
+			SkeletonJoint joint = { pPosition->X, pPosition->Y, pPosition->Z, 1.0f };
+			m_filter.Apply(nSlot, &joint, fTime);
+
+			hand.nId = nId;
+			hand.X = joint.X;
+			hand.Y = joint.Y;
+			hand.Z = joint.Z;
+			hand.fTime = fTime;
+		}
+
+		void XN_CALLBACK_TYPE HandTracker::OnHandCreate(xn::HandsGenerator& /*generator*/, XnUserID nId, const XnPoint3D* pPosition, XnFloat fTime, void* pCookie)
+		{
+			((HandTracker*)pCookie)->Store(nId, pPosition, fTime, true);
+		}
+
+		void XN_CALLBACK_TYPE HandTracker::OnHandUpdate(xn::HandsGenerator& /*generator*/, XnUserID nId, const XnPoint3D* pPosition, XnFloat fTime, void* pCookie)
+		{
+			((HandTracker*)pCookie)->Store(nId, pPosition, fTime, false);
+		}
+
+		void XN_CALLBACK_TYPE HandTracker::OnHandDestroy(xn::HandsGenerator& /*generator*/, XnUserID nId, XnFloat /*fTime*/, void* pCookie)
+		{
+			HandTracker* pThis = (HandTracker*)pCookie;
+			JointFilter::ScopedLock guard(pThis->m_filter);
+			for (XnUInt32 i = 0; i < pThis->m_nMaxHands; ++i)
+			{
+				if (pThis->m_hands[i].nId == nId)
+				{
+					pThis->m_hands[i].nId = 0;
+					pThis->m_filter.ResetSlot(i);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <XnOS.h>
+#include <XnCppWrapper.h>
+#include <vector>
+#include "JointFilter.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Hand point record, layout compatible with XnMHandPoint
+		struct HandPoint
+		{
+			XnUInt32 nId;
+			XnFloat X;
+			XnFloat Y;
+			XnFloat Z;
+			XnFloat fTime;
+		};
+
+		// Collects the hand points reported by the callbacks of a hands generator into a
+		// fixed-size table that can be copied out in one call. Callbacks run on the threads
+		// that update the context; the table and its filter are guarded by the filter lock.
+		class HandTracker
+		{
+		public:
+			HandTracker(xn::HandsGenerator& generator, XnUInt32 nMaxHands);
+			~HandTracker();
+
+			XnStatus Attach();
+			void Detach();
+
+			XnUInt32 GetMaxHands() const { return m_nMaxHands; }
+
+			// Copies the active hands (filtered) into pHands. Returns their number.
+			XnUInt32 GetHands(HandPoint* pHands, XnUInt32 nMaxHands) const;
+
+			JointFilter& GetFilter() { return m_filter; }
+
+		private:
+			static void XN_CALLBACK_TYPE OnHandCreate(xn::HandsGenerator& generator, XnUserID nId, const XnPoint3D* pPosition, XnFloat fTime, void* pCookie);
+			static void XN_CALLBACK_TYPE OnHandUpdate(xn::HandsGenerator& generator, XnUserID nId, const XnPoint3D* pPosition, XnFloat fTime, void* pCookie);
+			static void XN_CALLBACK_TYPE OnHandDestroy(xn::HandsGenerator& generator, XnUserID nId, XnFloat fTime, void* pCookie);
+
+			void Store(XnUserID nId, const XnPoint3D* pPosition, XnFloat fTime, bool bNew);
+
+			xn::HandsGenerator m_generator;
+			XnUInt32 m_nMaxHands;
+			XnCallbackHandle m_hCallbacks;
+
+			// slot per hand id (nId == 0 marks a free slot)
+			std::vector<HandPoint> m_hands;
+			JointFilter m_filter;
+		};
+	}
+}
@@ -0,0 +1,410 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "IcpTracker.h"
+#include "CpuDispatch.h"
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// depth differences above this are treated as discontinuities when downsampling (mm)
+		static const int PYRAMID_DEPTH_SIGMA = 30;
+
+		// stop iterating a level once the increment drops below these (radians, mm)
+		static const double MIN_ROTATION_STEP = 1e-5;
+		static const double MIN_TRANSLATION_STEP = 1e-2;
+
+		// 6x6 upper triangle, right hand side, squared error and inlier count
+		static const int SUM_RHS = 21;
+		static const int SUM_ERROR = 27;
+		static const int SUM_COUNT = 28;
+		static const int SUM_SIZE = 29;
+
+		struct IcpSums
+		{
+			double v[SUM_SIZE];
+		};
+
+		static inline bool IsValidNormal(const Vector3f& n)
+		{
+			return n.x != 0.0f || n.y != 0.0f || n.z != 0.0f;
+		}
+
+		// Solves the symmetric positive definite system A x = b by Cholesky decomposition
+		static bool SolveCholesky6(const double A[6][6], const double* b, double* x)
+		{
+			double L[6][6] = { { 0 } };
+			for (int i = 0; i < 6; ++i)
+			{
+				for (int j = 0; j <= i; ++j)
+				{
+					double sum = A[i][j];
+					for (int k = 0; k < j; ++k)
+						sum -= L[i][k] * L[j][k];
+
+					if (i == j)
+					{
+						if (sum <= 1e-9)
+							return false;
+						L[i][i] = sqrt(sum);
+					}
+					else
+					{
+						L[i][j] = sum / L[j][j];
+					}
+				}
+			}
+
+			double y[6];
+			for (int i = 0; i < 6; ++i)
+			{
+				double sum = b[i];
+				for (int k = 0; k < i; ++k)
+					sum -= L[i][k] * y[k];
+				y[i] = sum / L[i][i];
+			}
+			for (int i = 5; i >= 0; --i)
+			{
+				double sum = y[i];
+				for (int k = i + 1; k < 6; ++k)
+					sum -= L[k][i] * x[k];
+				x[i] = sum / L[i][i];
+			}
+			return true;
+		}
+
+		// Rigid transform of a rotation vector (Rodrigues) followed by a translation
+		static RigidTransform ExpTwist(const double* x)
+		{
+			RigidTransform t = RigidTransform::Identity();
+			double theta = sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+			if (theta > 1e-12)
+			{
+				double kx = x[0] / theta, ky = x[1] / theta, kz = x[2] / theta;
+				double c = cos(theta), s = sin(theta), v = 1.0 - c;
+				t.m[0] = (float)(kx * kx * v + c);      t.m[1] = (float)(kx * ky * v - kz * s); t.m[2] = (float)(kx * kz * v + ky * s);
+				t.m[4] = (float)(kx * ky * v + kz * s); t.m[5] = (float)(ky * ky * v + c);      t.m[6] = (float)(ky * kz * v - kx * s);
+				t.m[8] = (float)(kx * kz * v - ky * s); t.m[9] = (float)(ky * kz * v + kx * s); t.m[10] = (float)(kz * kz * v + c);
+			}
+			t.m[3] = (float)x[3];
+			t.m[7] = (float)x[4];
+			t.m[11] = (float)x[5];
+			return t;
+		}
+
+		static void ComputeVertexMap(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes,
+			const DepthIntrinsics& intrinsics, Vector3f* pVertices)
+		{
+			const CpuKernels& kernels = CpuDispatch::GetKernels();
+			Concurrency::parallel_for(0, (int)nYRes, [&](int y)
+			{
+				// Vector3f is laid out as an xyz float triple
+				kernels.pUnprojectRow(pDepth + y * nXRes, nXRes, (XnUInt32)y, intrinsics, (float*)(pVertices + y * nXRes));
+			});
+		}
+
+		// Normals from neighbouring vertices, pointing towards the camera.
+		// Invalid normals are left as zero vectors.
+		static void ComputeNormalMap(const Vector3f* pVertices, XnUInt32 nXRes, XnUInt32 nYRes, Vector3f* pNormals)
+		{
+			const float fMaxStep = (float)PYRAMID_DEPTH_SIGMA * 2;
+
+			Concurrency::parallel_for(0, (int)nYRes, [&](int y)
+			{
+				Vector3f* pOut = pNormals + y * nXRes;
+				for (XnUInt32 x = 0; x < nXRes; ++x)
+				{
+					pOut[x] = MakeVector3f(0, 0, 0);
+					if (x + 1 >= nXRes || (XnUInt32)y + 1 >= nYRes)
+						continue;
+
+					const Vector3f& v = pVertices[y * nXRes + x];
+					const Vector3f& vx = pVertices[y * nXRes + x + 1];
+					const Vector3f& vy = pVertices[(y + 1) * nXRes + x];
+					if (v.z == 0 || vx.z == 0 || vy.z == 0 ||
+						fabsf(vx.z - v.z) > fMaxStep || fabsf(vy.z - v.z) > fMaxStep)
+						continue;
+
+					pOut[x] = Normalize(Cross(vy - v, vx - v));
+				}
+			});
+		}
+
+		IcpTracker::IcpTracker(XnUInt32 nLevels)
+			: m_nLevels(nLevels == 0 ? 1 : (nLevels > MAX_LEVELS ? MAX_LEVELS : nLevels)),
+			  m_fDistanceThreshold(100.0f),
+			  m_fAngleThreshold(0.35f),
+			  m_fMinInlierRatio(0.1f),
+			  m_bHasReference(false)
+		{
+			m_nIterations[0] = 4;
+			m_nIterations[1] = 5;
+			m_nIterations[2] = 10;
+			m_nIterations[3] = 10;
+			m_intrinsics = DepthIntrinsics::Create(575.8f, 319.5f, 239.5f);
+			m_pose = RigidTransform::Identity();
+		}
+
+		void IcpTracker::Reset()
+		{
+			m_bHasReference = false;
+			m_pose = RigidTransform::Identity();
+		}
+
+		void IcpTracker::BuildPyramid(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes, Level* pLevels)
+		{
+			for (XnUInt32 l = 0; l < m_nLevels; ++l)
+			{
+				Level& level = pLevels[l];
+				level.nXRes = nXRes >> l;
+				level.nYRes = nYRes >> l;
+				level.intrinsics = m_intrinsics.Scaled(1.0f / (1 << l));
+
+				size_t nPixels = (size_t)level.nXRes * level.nYRes;
+				level.depth.resize(nPixels);
+				level.vertices.resize(nPixels);
+				level.normals.resize(nPixels);
+
+				if (l == 0)
+				{
+					memcpy(&level.depth[0], pDepth, nPixels * sizeof(XnUInt16));
+				}
+				else
+				{
+					// average the 2x2 block, ignoring samples across depth discontinuities
+					const Level& finer = pLevels[l - 1];
+					Concurrency::parallel_for(0, (int)level.nYRes, [&](int y)
+					{
+						for (XnUInt32 x = 0; x < level.nXRes; ++x)
+						{
+							const XnUInt16* p = &finer.depth[(2 * y) * finer.nXRes + 2 * x];
+							XnUInt16 samples[4] = { p[0], p[1], p[finer.nXRes], p[finer.nXRes + 1] };
+
+							int center = 0;
+							for (int i = 0; i < 4 && center == 0; ++i)
+								center = samples[i];
+
+							int sum = 0, count = 0;
+							for (int i = 0; i < 4; ++i)
+							{
+								int d = samples[i];
+								if (d != 0 && abs(d - center) < PYRAMID_DEPTH_SIGMA)
+								{
+									sum += d;
+									++count;
+								}
+							}
+							level.depth[y * level.nXRes + x] = (XnUInt16)(count ? sum / count : 0);
+						}
+					});
+				}
+
+				ComputeVertexMap(&level.depth[0], level.nXRes, level.nYRes, level.intrinsics, &level.vertices[0]);
+				ComputeNormalMap(&level.vertices[0], level.nXRes, level.nYRes, &level.normals[0]);
+			}
+		}
+
+		void IcpTracker::SetReference(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes)
+		{
+			BuildPyramid(pDepth, nXRes, nYRes, m_reference);
+			m_bHasReference = true;
+		}
+
+		void IcpTracker::SetReference(const XnUInt16* pDepth, const float* pNormals, XnUInt32 nXRes, XnUInt32 nYRes)
+		{
+			BuildPyramid(pDepth, nXRes, nYRes, m_reference);
+
+			// the raycast normals come from the fused surface and are less noisy on the finest level
+			if (pNormals != NULL)
+			{
+				Level& level = m_reference[0];
+				for (size_t i = 0; i < level.normals.size(); ++i)
+				{
+					Vector3f n = MakeVector3f(pNormals[3 * i], pNormals[3 * i + 1], pNormals[3 * i + 2]);
+					level.normals[i] = (level.depth[i] != 0 && n.x == n.x) ? n : MakeVector3f(0, 0, 0);
+				}
+			}
+			m_bHasReference = true;
+		}
+
+		bool IcpTracker::Iterate(const Level& current, const Level& reference, RigidTransform& delta,
+			float& fResidual, XnUInt32& nInliers, bool& bDone)
+		{
+			const float fDistSq = m_fDistanceThreshold * m_fDistanceThreshold;
+			const float fMinCos = cosf(m_fAngleThreshold);
+			const DepthIntrinsics& in = reference.intrinsics;
+			const RigidTransform T = delta;
+
+			Concurrency::combinable<IcpSums> sums([]() -> IcpSums
+			{
+				IcpSums zero;
+				memset(&zero, 0, sizeof(zero));
+				return zero;
+			});
+
+			Concurrency::parallel_for(0, (int)current.nYRes, [&](int y)
+			{
+				// accumulate the row in floats and fold it into the doubles once
+				float row[SUM_SIZE];
+				memset(row, 0, sizeof(row));
+
+				const Vector3f* pV = &current.vertices[y * current.nXRes];
+				const Vector3f* pN = &current.normals[y * current.nXRes];
+
+				for (XnUInt32 x = 0; x < current.nXRes; ++x)
+				{
+					if (!IsValidNormal(pN[x]))
+						continue;
+
+					// projective data association
+					Vector3f p = T.Apply(pV[x]);
+					if (p.z <= 0.0f)
+						continue;
+					int u = (int)(p.x * in.fx / p.z + in.cx + 0.5f);
+					int v = (int)(p.y * in.fy / p.z + in.cy + 0.5f);
+					if (u < 0 || v < 0 || u >= (int)reference.nXRes || v >= (int)reference.nYRes)
+						continue;
+
+					const Vector3f& n = reference.normals[v * reference.nXRes + u];
+					if (!IsValidNormal(n))
+						continue;
+					const Vector3f& q = reference.vertices[v * reference.nXRes + u];
+
+					Vector3f d = q - p;
+					if (Dot(d, d) > fDistSq || Dot(T.Rotate(pN[x]), n) < fMinCos)
+						continue;
+
+					Vector3f c = Cross(p, n);
+					float a[6] = { c.x, c.y, c.z, n.x, n.y, n.z };
+					float b = Dot(n, d);
+
+					int k = 0;
+					for (int i = 0; i < 6; ++i)
+					{
+						for (int j = i; j < 6; ++j)
+							row[k++] += a[i] * a[j];
+						row[SUM_RHS + i] += a[i] * b;
+					}
+					row[SUM_ERROR] += b * b;
+					row[SUM_COUNT] += 1.0f;
+				}
+
+				IcpSums& local = sums.local();
+				for (int i = 0; i < SUM_SIZE; ++i)
+					local.v[i] += row[i];
+			});
+
+			IcpSums total;
+			memset(&total, 0, sizeof(total));
+			sums.combine_each([&](const IcpSums& local)
+			{
+				for (int i = 0; i < SUM_SIZE; ++i)
+					total.v[i] += local.v[i];
+			});
+
+			nInliers = (XnUInt32)total.v[SUM_COUNT];
+			fResidual = nInliers ? (float)sqrt(total.v[SUM_ERROR] / nInliers) : 0.0f;
+			if (nInliers < 6)
+				return false;
+
+			double A[6][6];
+			int k = 0;
+			for (int i = 0; i < 6; ++i)
+			{
+				for (int j = i; j < 6; ++j)
+				{
+					A[i][j] = A[j][i] = total.v[k++];
+				}
+			}
+
+			double x[6];
+			if (!SolveCholesky6(A, &total.v[SUM_RHS], x))
+				return false;
+
+			delta = ExpTwist(x).Compose(delta);
+
+			double rot = sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+			double trans = sqrt(x[3] * x[3] + x[4] * x[4] + x[5] * x[5]);
+			bDone = rot < MIN_ROTATION_STEP && trans < MIN_TRANSLATION_STEP;
+			return true;
+		}
+
+		XnStatus IcpTracker::Track(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes, bool bUpdateReference, IcpResult& result)
+		{
+			if (pDepth == NULL || (nXRes >> (m_nLevels - 1)) < 2 || (nYRes >> (m_nLevels - 1)) < 2)
+				return XN_STATUS_BAD_PARAM;
+
+			result.pose = m_pose;
+			result.delta = RigidTransform::Identity();
+			result.fResidual = 0.0f;
+			result.nInliers = 0;
+			result.nValidPoints = 0;
+			result.nIterations = 0;
+			result.bConverged = false;
+
+			BuildPyramid(pDepth, nXRes, nYRes, m_current);
+
+			if (!m_bHasReference || m_reference[0].nXRes != nXRes || m_reference[0].nYRes != nYRes)
+			{
+				// first frame only establishes the reference
+				if (bUpdateReference)
+					SetReference(pDepth, nXRes, nYRes);
+				return XN_STATUS_OK;
+			}
+
+			const Level& finest = m_current[0];
+			for (size_t i = 0; i < finest.normals.size(); ++i)
+			{
+				if (IsValidNormal(finest.normals[i]))
+					++result.nValidPoints;
+			}
+
+			RigidTransform delta = RigidTransform::Identity();
+			bool bSolved = true;
+			for (int l = (int)m_nLevels - 1; l >= 0 && bSolved; --l)
+			{
+				for (XnUInt32 i = 0; i < m_nIterations[l]; ++i)
+				{
+					bool bDone = false;
+					++result.nIterations;
+					if (!Iterate(m_current[l], m_reference[l], delta, result.fResidual, result.nInliers, bDone))
+					{
+						bSolved = false;
+						break;
+					}
+					if (bDone)
+						break;
+				}
+			}
+
+			result.bConverged = bSolved && result.nValidPoints > 0 &&
+				result.nInliers >= m_fMinInlierRatio * result.nValidPoints;
+
+			if (result.bConverged)
+			{
+				m_pose = m_pose.Compose(delta);
+				result.delta = delta;
+				result.pose = m_pose;
+			}
+
+			// a frame that failed to align would carry its pose error into every later frame
+			if (bUpdateReference && result.bConverged)
+			{
+				for (XnUInt32 l = 0; l < m_nLevels; ++l)
+				{
+					Level& ref = m_reference[l];
+					Level& cur = m_current[l];
+					ref.nXRes = cur.nXRes;
+					ref.nYRes = cur.nYRes;
+					ref.intrinsics = cur.intrinsics;
+					ref.depth.swap(cur.depth);
+					ref.vertices.swap(cur.vertices);
+					ref.normals.swap(cur.normals);
+				}
+			}
+
+			return XN_STATUS_OK;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <XnOS.h>
+#include <vector>
+#include "Geometry.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		struct IcpResult
+		{
+			RigidTransform pose;		// camera-to-world pose after the update
+			RigidTransform delta;		// current camera to reference camera
+			float fResidual;			// RMS point-to-plane error of the inliers (mm)
+			XnUInt32 nInliers;			// associated points on the finest level
+			XnUInt32 nValidPoints;		// valid depth pixels on the finest level
+			XnUInt32 nIterations;		// iterations over all levels
+			bool bConverged;
+		};
+
+		// Coarse-to-fine projective point-to-plane ICP. Each tracked depth frame is aligned to
+		// a reference surface given in the reference camera's frame - the previous frame, or 
+		// a model raycast from the current pose.
+		class IcpTracker
+		{
+		public:
+			static const XnUInt32 MAX_LEVELS = 4;
+
+			IcpTracker(XnUInt32 nLevels);
+
+			void SetIntrinsics(const DepthIntrinsics& intrinsics) { m_intrinsics = intrinsics; }
+			const DepthIntrinsics& GetIntrinsics() const { return m_intrinsics; }
+
+			const RigidTransform& GetPose() const { return m_pose; }
+			void SetPose(const RigidTransform& pose) { m_pose = pose; }
+
+			// Drops the reference and resets the pose to identity.
+			void Reset();
+			bool HasReference() const { return m_bHasReference; }
+
+			// Uses a depth map (mm) as the reference surface.
+			void SetReference(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes);
+			// Uses a raycast depth map and its camera-space normals (xyz triples) as the reference surface.
+			void SetReference(const XnUInt16* pDepth, const float* pNormals, XnUInt32 nXRes, XnUInt32 nYRes);
+
+			// Aligns the depth map to the reference and updates the pose when tracking succeeds.
+			// In frame-to-frame mode the frame then becomes the new reference; a frame that
+			// did not converge leaves the reference unchanged.
+			XnStatus Track(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes, bool bUpdateReference, IcpResult& result);
+
+			XnUInt32 GetLevels() const { return m_nLevels; }
+			void SetIterations(XnUInt32 nLevel, XnUInt32 nIterations) { if (nLevel < MAX_LEVELS) m_nIterations[nLevel] = nIterations; }
+			XnUInt32 GetIterations(XnUInt32 nLevel) const { return nLevel < MAX_LEVELS ? m_nIterations[nLevel] : 0; }
+
+			float GetDistanceThreshold() const { return m_fDistanceThreshold; }
+			void SetDistanceThreshold(float fDistance) { m_fDistanceThreshold = fDistance; }
+
+			// Maximal angle (radians) between associated normals.
+			float GetAngleThreshold() const { return m_fAngleThreshold; }
+			void SetAngleThreshold(float fAngle) { m_fAngleThreshold = fAngle; }
+
+			// Minimal share of valid points that must be associated for tracking to succeed.
+			float GetMinInlierRatio() const { return m_fMinInlierRatio; }
+			void SetMinInlierRatio(float fRatio) { m_fMinInlierRatio = fRatio; }
+
+		private:
+			struct Level
+			{
+				XnUInt32 nXRes;
+				XnUInt32 nYRes;
+				DepthIntrinsics intrinsics;
+				std::vector<XnUInt16> depth;
+				std::vector<Vector3f> vertices;
+				std::vector<Vector3f> normals;
+			};
+
+			void BuildPyramid(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes, Level* pLevels);
+			bool Iterate(const Level& current, const Level& reference, RigidTransform& delta,
+				float& fResidual, XnUInt32& nInliers, bool& bDone);
+
+			XnUInt32 m_nLevels;
+			XnUInt32 m_nIterations[MAX_LEVELS];
+			float m_fDistanceThreshold;
+			float m_fAngleThreshold;
+			float m_fMinInlierRatio;
+
+			DepthIntrinsics m_intrinsics;
+			RigidTransform m_pose;
+			bool m_bHasReference;
+
+			Level m_reference[MAX_LEVELS];
+			Level m_current[MAX_LEVELS];
+		};
+	}
+}
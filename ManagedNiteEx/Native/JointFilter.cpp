@@ -0,0 +1,227 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "JointFilter.h"
+#include <math.h>
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		static const XnFloat PI = 3.14159265f;
+
+		// used when consecutive timestamps are missing or equal
+		static const XnFloat DEFAULT_DELTA_TIME = 1.0f / 30.0f;
+
+		static inline XnFloat Length3(const XnFloat* v)
+		{
+			return sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		}
+
+		static inline XnFloat SmoothingFactor(XnFloat fCutoff, XnFloat fDeltaTime)
+		{
+			XnFloat tau = 1.0f / (2.0f * PI * fCutoff);
+			return 1.0f / (1.0f + tau / fDeltaTime);
+		}
+
+		JointFilter::JointFilter(XnUInt32 nSlots, XnUInt32 nJointsPerSlot)
+			: m_nSlots(nSlots), m_nJointsPerSlot(nJointsPerSlot),
+			  m_mode(MODE_DOUBLE_EXPONENTIAL),
+			  m_fMinConfidence(0.5f), m_nMaxHoldFrames(10),
+			  m_states((size_t)nSlots * nJointsPerSlot), m_lastTimes(nSlots),
+			  m_pLock(new Concurrency::critical_section())
+		{
+			DoubleExponentialParams doubleExp = { 0.5f, 0.5f, 0.5f, 50.0f, 40.0f };
+			m_doubleExp = doubleExp;
+
+			OneEuroParams oneEuro = { 1.0f, 0.02f, 1.0f };
+			m_oneEuro = oneEuro;
+
+			Reset();
+		}
+
+		JointFilter::~JointFilter()
+		{
+			delete (Concurrency::critical_section*)m_pLock;
+		}
+
+		void JointFilter::Lock() const
+		{
+			((Concurrency::critical_section*)m_pLock)->lock();
+		}
+
+		void JointFilter::Unlock() const
+		{
+			((Concurrency::critical_section*)m_pLock)->unlock();
+		}
+
+		void JointFilter::SetMode(Mode mode)
+		{
+			if (mode != m_mode)
+			{
+				m_mode = mode;
+				Reset();
+			}
+		}
+
+		void JointFilter::ResetSlot(XnUInt32 nSlot)
+		{
+			if (nSlot >= m_nSlots)
+				return;
+
+			memset(&m_states[nSlot * m_nJointsPerSlot], 0, m_nJointsPerSlot * sizeof(State));
+			m_lastTimes[nSlot] = -1.0;
+		}
+
+		void JointFilter::Reset()
+		{
+			for (XnUInt32 i = 0; i < m_nSlots; ++i)
+				ResetSlot(i);
+		}
+
+		void JointFilter::Apply(XnUInt32 nSlot, SkeletonJoint* pJoints, XnDouble fTime)
+		{
+			if (nSlot >= m_nSlots || m_mode == MODE_NONE)
+				return;
+
+			XnFloat fDeltaTime = (m_lastTimes[nSlot] >= 0.0 && fTime > m_lastTimes[nSlot]) ? 
+				(XnFloat)(fTime - m_lastTimes[nSlot]) : DEFAULT_DELTA_TIME;
+			m_lastTimes[nSlot] = fTime;
+
+			State* pStates = &m_states[nSlot * m_nJointsPerSlot];
+			for (XnUInt32 j = 0; j < m_nJointsPerSlot; ++j)
+			{
+				State& state = pStates[j];
+				SkeletonJoint& joint = pJoints[j];
+
+				if (joint.fConfidence < m_fMinConfidence)
+				{
+					// keep reporting the last good position for a while so short dropouts don't jump
+					if (state.nFrames > 0 && state.nHeldFrames < m_nMaxHoldFrames)
+					{
+						++state.nHeldFrames;
+						joint.X = state.output[0];
+						joint.Y = state.output[1];
+						joint.Z = state.output[2];
+					}
+					else
+					{
+						state.nFrames = 0;
+					}
+					continue;
+				}
+
+				// reacquired after a long dropout - restart from the raw position
+				if (state.nHeldFrames >= m_nMaxHoldFrames)
+					state.nFrames = 0;
+				state.nHeldFrames = 0;
+
+				XnFloat raw[3] = { joint.X, joint.Y, joint.Z };
+				if (m_mode == MODE_DOUBLE_EXPONENTIAL)
+					ApplyDoubleExponential(state, raw);
+				else
+					ApplyOneEuro(state, raw, fDeltaTime);
+
+				++state.nFrames;
+				joint.X = state.output[0];
+				joint.Y = state.output[1];
+				joint.Z = state.output[2];
+			}
+		}
+
+		void JointFilter::ApplyDoubleExponential(State& state, const XnFloat* raw)
+		{
+			const DoubleExponentialParams& p = m_doubleExp;
+			XnFloat input[3] = { raw[0], raw[1], raw[2] };
+			XnFloat prevFiltered[3] = { state.filtered[0], state.filtered[1], state.filtered[2] };
+
+			if (state.nFrames == 0)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					state.filtered[i] = input[i];
+					state.trend[i] = 0.0f;
+				}
+			}
+			else if (state.nFrames == 1)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					state.filtered[i] = (input[i] + state.raw[i]) * 0.5f;
+					state.trend[i] = (state.filtered[i] - prevFiltered[i]) * p.fCorrection + state.trend[i] * (1.0f - p.fCorrection);
+				}
+			}
+			else
+			{
+				// damp small movements towards the previous estimate
+				XnFloat diff[3] = { input[0] - prevFiltered[0], input[1] - prevFiltered[1], input[2] - prevFiltered[2] };
+				XnFloat len = Length3(diff);
+				if (len <= p.fJitterRadius && p.fJitterRadius > 0.0f)
+				{
+					XnFloat w = len / p.fJitterRadius;
+					for (int i = 0; i < 3; ++i)
+						input[i] = input[i] * w + prevFiltered[i] * (1.0f - w);
+				}
+
+				for (int i = 0; i < 3; ++i)
+				{
+					state.filtered[i] = input[i] * (1.0f - p.fSmoothing) + (prevFiltered[i] + state.trend[i]) * p.fSmoothing;
+					state.trend[i] = (state.filtered[i] - prevFiltered[i]) * p.fCorrection + state.trend[i] * (1.0f - p.fCorrection);
+				}
+			}
+
+			XnFloat predicted[3];
+			for (int i = 0; i < 3; ++i)
+				predicted[i] = state.filtered[i] + state.trend[i] * p.fPrediction;
+
+			// never drift too far from the measurement
+			XnFloat dev[3] = { predicted[0] - raw[0], predicted[1] - raw[1], predicted[2] - raw[2] };
+			XnFloat devLen = Length3(dev);
+			if (devLen > p.fMaxDeviationRadius && p.fMaxDeviationRadius > 0.0f)
+			{
+				XnFloat w = p.fMaxDeviationRadius / devLen;
+				for (int i = 0; i < 3; ++i)
+					predicted[i] = predicted[i] * w + raw[i] * (1.0f - w);
+			}
+
+			for (int i = 0; i < 3; ++i)
+			{
+				state.raw[i] = raw[i];
+				state.output[i] = predicted[i];
+			}
+		}
+
+		void JointFilter::ApplyOneEuro(State& state, const XnFloat* raw, XnFloat fDeltaTime)
+		{
+			const OneEuroParams& p = m_oneEuro;
+
+			if (state.nFrames == 0)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					state.filtered[i] = raw[i];
+					state.trend[i] = 0.0f;
+					state.raw[i] = raw[i];
+					state.output[i] = raw[i];
+				}
+				return;
+			}
+
+			// filtered speed drives the cutoff, so fast motion is followed with little lag
+			XnFloat alphaD = SmoothingFactor(p.fDerivativeCutoff, fDeltaTime);
+			for (int i = 0; i < 3; ++i)
+			{
+				XnFloat speed = (raw[i] - state.raw[i]) / fDeltaTime;
+				state.trend[i] += alphaD * (speed - state.trend[i]);
+			}
+
+			XnFloat alpha = SmoothingFactor(p.fMinCutoff + p.fBeta * Length3(state.trend), fDeltaTime);
+			for (int i = 0; i < 3; ++i)
+			{
+				state.filtered[i] += alpha * (raw[i] - state.filtered[i]);
+				state.raw[i] = raw[i];
+				state.output[i] = state.filtered[i];
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <XnOS.h>
+#include <vector>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Skeleton joint as delivered to managed code, layout compatible with XnMSkeletonJoint
+		struct SkeletonJoint
+		{
+			XnFloat X;
+			XnFloat Y;
+			XnFloat Z;
+			XnFloat fConfidence;
+		};
+
+		struct DoubleExponentialParams
+		{
+			XnFloat fSmoothing;			// [0, 1), higher is smoother and laggier
+			XnFloat fCorrection;		// [0, 1], how fast the trend follows the data
+			XnFloat fPrediction;		// frames to predict into the future
+			XnFloat fJitterRadius;		// mm, raw movements below this are damped
+			XnFloat fMaxDeviationRadius;	// mm, maximal distance of the output from the raw data
+		};
+
+		struct OneEuroParams
+		{
+			XnFloat fMinCutoff;			// Hz, cutoff at rest
+			XnFloat fBeta;				// cutoff increase per mm/s of speed
+			XnFloat fDerivativeCutoff;	// Hz, cutoff of the speed estimate
+		};
+
+		// Temporal smoothing of a fixed number of joints, with state kept in preallocated slots.
+		// Joints below the confidence threshold do not update the filter; the last output is
+		// held for a limited number of frames before the joint is reported as lost.
+		// The filter does not lock itself; owners that filter on callback threads hold Lock
+		// around Apply/ResetSlot, and so do the managed settings.
+		class JointFilter
+		{
+		public:
+			// Holds the lock of a filter for its lifetime.
+			class ScopedLock
+			{
+			public:
+				explicit ScopedLock(const JointFilter& filter) : m_filter(filter) { m_filter.Lock(); }
+				~ScopedLock() { m_filter.Unlock(); }
+
+			private:
+				ScopedLock(const ScopedLock&);
+				ScopedLock& operator=(const ScopedLock&);
+
+				const JointFilter& m_filter;
+			};
+
+			enum Mode
+			{
+				MODE_NONE = 0,
+				MODE_DOUBLE_EXPONENTIAL = 1,
+				MODE_ONE_EURO = 2,
+			};
+
+			JointFilter(XnUInt32 nSlots, XnUInt32 nJointsPerSlot);
+			~JointFilter();
+
+			void Lock() const;
+			void Unlock() const;
+
+			Mode GetMode() const { return m_mode; }
+			void SetMode(Mode mode);
+
+			const DoubleExponentialParams& GetDoubleExponentialParams() const { return m_doubleExp; }
+			void SetDoubleExponentialParams(const DoubleExponentialParams& params) { m_doubleExp = params; }
+
+			const OneEuroParams& GetOneEuroParams() const { return m_oneEuro; }
+			void SetOneEuroParams(const OneEuroParams& params) { m_oneEuro = params; }
+
+			XnFloat GetMinConfidence() const { return m_fMinConfidence; }
+			void SetMinConfidence(XnFloat fConfidence) { m_fMinConfidence = fConfidence; }
+
+			XnUInt32 GetMaxHoldFrames() const { return m_nMaxHoldFrames; }
+			void SetMaxHoldFrames(XnUInt32 nFrames) { m_nMaxHoldFrames = nFrames; }
+
+			// Filters the joints of one slot in place. fTime is the frame time in seconds.
+			void Apply(XnUInt32 nSlot, SkeletonJoint* pJoints, XnDouble fTime);
+
+			// Forgets the history of a slot (e.g. when its user is lost).
+			void ResetSlot(XnUInt32 nSlot);
+			void Reset();
+
+		private:
+			JointFilter(const JointFilter&);
+			JointFilter& operator=(const JointFilter&);
+
+			struct State
+			{
+				XnFloat raw[3];
+				XnFloat filtered[3];
+				XnFloat trend[3];		// double exponential trend, one euro speed
+				XnFloat output[3];
+				XnUInt32 nFrames;		// updates since the last reset
+				XnUInt32 nHeldFrames;	// consecutive frames below the confidence threshold
+			};
+
+			void ApplyDoubleExponential(State& state, const XnFloat* raw);
+			void ApplyOneEuro(State& state, const XnFloat* raw, XnFloat fDeltaTime);
+
+			XnUInt32 m_nSlots;
+			XnUInt32 m_nJointsPerSlot;
+			Mode m_mode;
+			DoubleExponentialParams m_doubleExp;
+			OneEuroParams m_oneEuro;
+			XnFloat m_fMinConfidence;
+			XnUInt32 m_nMaxHoldFrames;
+
+			std::vector<State> m_states;
+			std::vector<XnDouble> m_lastTimes;
+			void* m_pLock;
+		};
+	}
+}
@@ -0,0 +1,206 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <windows.h>
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		OccupancyGrid::OccupancyGrid(float fOriginX, float fOriginZ, float fCellSize, XnUInt32 nCellsX, XnUInt32 nCellsZ, XnUInt32 nLayers)
+			: m_fOriginX(fOriginX), m_fOriginZ(fOriginZ), m_fCellSize(fCellSize),
+			  m_nCellsX(nCellsX), m_nCellsZ(nCellsZ), m_nLayers(nLayers == 0 ? 1 : nLayers)
+		{
+			m_counts.resize((size_t)m_nCellsX * m_nCellsZ * m_nLayers);
+			m_heights.resize(m_counts.size());
+			Clear();
+		}
+
+		void OccupancyGrid::Clear()
+		{
+			std::fill(m_counts.begin(), m_counts.end(), 0u);
+			std::fill(m_heights.begin(), m_heights.end(), NO_HEIGHT);
+		}
+
+		void OccupancyGrid::MergeCell(XnUInt32 nIndex, XnUInt32 nCount, XnInt32 nHeight)
+		{
+			InterlockedExchangeAdd((volatile LONG*)&m_counts[nIndex], (LONG)nCount);
+
+			volatile LONG* pHeight = (volatile LONG*)&m_heights[nIndex];
+			LONG current = *pHeight;
+			while (nHeight > current)
+			{
+				LONG previous = InterlockedCompareExchange(pHeight, nHeight, current);
+				if (previous == current)
+					break;
+				current = previous;
+			}
+		}
+
+		OccupancyProjector::OccupancyProjector()
+			: m_fMinHeight(0.0f), m_fMaxHeight(2500.0f), m_nPixelStep(1)
+		{
+			m_intrinsics = DepthIntrinsics::Create(575.8f, 319.5f, 239.5f);
+			m_sensorToFloor = RigidTransform::Identity();
+		}
+
+		void OccupancyProjector::SetFloorPlane(const Vector3f& point, const Vector3f& normal)
+		{
+			// real world coordinates are camera coordinates with Y pointing up
+			Vector3f up = Normalize(normal);
+			if (up.y < 0.0f)
+				up = up * -1.0f;
+
+			// keep the sensor's X direction on the floor as far as possible
+			Vector3f xAxis = MakeVector3f(1, 0, 0);
+			xAxis = Normalize(xAxis - up * Dot(xAxis, up));
+			Vector3f zAxis = Cross(xAxis, up);
+
+			// floor point below the sensor
+			Vector3f origin = up * Dot(point, up);
+
+			const Vector3f axes[3] = { xAxis, up, zAxis };
+			for (int r = 0; r < 3; ++r)
+			{
+				// fold the camera to real world Y flip into the rotation
+				m_sensorToFloor.m[r * 4 + 0] = axes[r].x;
+				m_sensorToFloor.m[r * 4 + 1] = -axes[r].y;
+				m_sensorToFloor.m[r * 4 + 2] = axes[r].z;
+				m_sensorToFloor.m[r * 4 + 3] = -Dot(axes[r], origin);
+			}
+		}
+
+		XnUInt32 OccupancyProjector::Project(const XnUInt16* pDepth, const XnUInt16* pLabels, XnUInt32 nXRes, XnUInt32 nYRes, OccupancyGrid& grid)
+		{
+			if (pDepth == NULL || nXRes == 0 || nYRes == 0)
+				return 0;
+
+			const XnUInt32 nCells = grid.GetCellCount();
+			const XnUInt32 nLayers = grid.GetLayers();
+			const XnUInt32 nGridSize = nCells * nLayers;
+			const XnUInt32 nGridRows = grid.GetCellsZ() * nLayers;
+			const XnUInt32 nStep = m_nPixelStep;
+			const XnUInt32 nRows = (nYRes + nStep - 1) / nStep;
+
+			// one partial grid per chunk of rows, kept between frames
+			XnUInt32 nChunks = Concurrency::GetProcessorCount();
+			if (nChunks > nRows)
+				nChunks = nRows;
+			if (m_partials.size() < nChunks)
+				m_partials.resize(nChunks);
+			for (XnUInt32 c = 0; c < nChunks; ++c)
+			{
+				Partial& partial = m_partials[c];
+				if (partial.counts.size() != nGridSize || partial.touchedRows.size() != nGridRows)
+				{
+					partial.counts.assign(nGridSize, 0);
+					partial.heights.assign(nGridSize, OccupancyGrid::NO_HEIGHT);
+					partial.touchedRows.assign(nGridRows, 0);
+				}
+				partial.nPoints = 0;
+			}
+
+			const float fInvCell = 1.0f / grid.GetCellSize();
+			const float fOriginX = grid.GetOriginX();
+			const float fOriginZ = grid.GetOriginZ();
+			const XnInt32 nCellsX = grid.GetCellsX();
+			const XnInt32 nCellsZ = grid.GetCellsZ();
+			const RigidTransform T = m_sensorToFloor;
+			const DepthIntrinsics in = m_intrinsics;
+
+			Concurrency::parallel_for(0, (int)nChunks, [&](int c)
+			{
+				Partial& partial = m_partials[c];
+				XnUInt32* pCounts = &partial.counts[0];
+				XnInt32* pHeights = &partial.heights[0];
+				XnUInt8* pTouched = &partial.touchedRows[0];
+				XnUInt32 nPoints = 0;
+
+				XnUInt32 nFirst = nRows * c / nChunks;
+				XnUInt32 nLast = nRows * (c + 1) / nChunks;
+				for (XnUInt32 r = nFirst; r < nLast; ++r)
+				{
+					XnUInt32 v = r * nStep;
+					const XnUInt16* pRow = pDepth + v * nXRes;
+					const XnUInt16* pLabelRow = pLabels ? pLabels + v * nXRes : NULL;
+
+					// the camera ray of the row changes linearly along u
+					float fRayY = (v - in.cy) / in.fy;
+					for (XnUInt32 u = 0; u < nXRes; u += nStep)
+					{
+						XnUInt16 z = pRow[u];
+						if (z == 0)
+							continue;
+
+						Vector3f p = T.Apply(MakeVector3f((u - in.cx) / in.fx * z, fRayY * z, z));
+						if (p.y < m_fMinHeight || p.y > m_fMaxHeight)
+							continue;
+
+						XnInt32 cx = (XnInt32)floorf((p.x - fOriginX) * fInvCell);
+						XnInt32 cz = (XnInt32)floorf((p.z - fOriginZ) * fInvCell);
+						if (cx < 0 || cz < 0 || cx >= nCellsX || cz >= nCellsZ)
+							continue;
+
+						XnUInt32 nLayer = pLabelRow ? pLabelRow[u] : 0;
+						if (nLayer >= nLayers)
+							continue;
+
+						pTouched[nLayer * nCellsZ + cz] = 1;
+						XnUInt32 nIndex = nLayer * nCells + cz * nCellsX + cx;
+						++pCounts[nIndex];
+						XnInt32 nHeight = (XnInt32)p.y;
+						if (nHeight > pHeights[nIndex])
+							pHeights[nIndex] = nHeight;
+						++nPoints;
+					}
+				}
+				partial.nPoints = nPoints;
+			});
+
+			// merge the partials into the shared grid and clear them for the next frame
+			XnUInt32 nTotal = 0;
+			for (XnUInt32 c = 0; c < nChunks; ++c)
+				nTotal += m_partials[c].nPoints;
+
+			// rows no chunk touched are still clear, so the merge visits only the touched ones
+			Concurrency::parallel_for(0, (int)nGridRows, [&](int nRow)
+			{
+				bool bTouched = false;
+				for (XnUInt32 c = 0; c < nChunks && !bTouched; ++c)
+					bTouched = m_partials[c].touchedRows[nRow] != 0;
+				if (!bTouched)
+					return;
+
+				XnUInt32 nBegin = (XnUInt32)nRow * (XnUInt32)nCellsX;
+				XnUInt32 nEnd = nBegin + (XnUInt32)nCellsX;
+				for (XnUInt32 i = nBegin; i < nEnd; ++i)
+				{
+					XnUInt32 nCount = 0;
+					XnInt32 nHeight = OccupancyGrid::NO_HEIGHT;
+					for (XnUInt32 c = 0; c < nChunks; ++c)
+					{
+						Partial& partial = m_partials[c];
+						if (!partial.touchedRows[nRow] || partial.counts[i] == 0)
+							continue;
+
+						nCount += partial.counts[i];
+						if (partial.heights[i] > nHeight)
+							nHeight = partial.heights[i];
+						partial.counts[i] = 0;
+						partial.heights[i] = OccupancyGrid::NO_HEIGHT;
+					}
+
+					if (nCount != 0)
+						grid.MergeCell(i, nCount, nHeight);
+				}
+
+				for (XnUInt32 c = 0; c < nChunks; ++c)
+					m_partials[c].touchedRows[nRow] = 0;
+			});
+
+			return nTotal;
+		}
+	}
+}
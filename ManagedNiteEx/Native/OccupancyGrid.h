@@ -0,0 +1,104 @@
+#pragma once
+
+#include <XnOS.h>
+#include <vector>
+#include "Geometry.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Top-down grid over the floor plane. Each cell of each layer keeps the number of points
+		// that fell into it and the highest point (mm above the floor). Layer 0 collects points
+		// without a user label, layer n those of user n when splitting by label.
+		// Merging into the grid uses interlocked operations only, so several sensors may
+		// project into one grid concurrently.
+		class OccupancyGrid
+		{
+		public:
+			static const XnInt32 NO_HEIGHT = -0x7FFFFFFF;
+
+			OccupancyGrid(float fOriginX, float fOriginZ, float fCellSize, XnUInt32 nCellsX, XnUInt32 nCellsZ, XnUInt32 nLayers);
+
+			void Clear();
+
+			float GetOriginX() const { return m_fOriginX; }
+			float GetOriginZ() const { return m_fOriginZ; }
+			float GetCellSize() const { return m_fCellSize; }
+			XnUInt32 GetCellsX() const { return m_nCellsX; }
+			XnUInt32 GetCellsZ() const { return m_nCellsZ; }
+			XnUInt32 GetLayers() const { return m_nLayers; }
+			XnUInt32 GetCellCount() const { return m_nCellsX * m_nCellsZ; }
+
+			// Row-major (z rows of x cells) arrays of one layer.
+			const XnUInt32* GetCounts(XnUInt32 nLayer) const { return &m_counts[nLayer * GetCellCount()]; }
+			const XnInt32* GetHeights(XnUInt32 nLayer) const { return &m_heights[nLayer * GetCellCount()]; }
+
+			// Adds a count and raises the height of a cell atomically.
+			void MergeCell(XnUInt32 nIndex, XnUInt32 nCount, XnInt32 nHeight);
+
+		private:
+			float m_fOriginX;
+			float m_fOriginZ;
+			float m_fCellSize;
+			XnUInt32 m_nCellsX;
+			XnUInt32 m_nCellsZ;
+			XnUInt32 m_nLayers;
+
+			// updated through interlocked functions, which operate on 32-bit LONGs
+			std::vector<XnUInt32> m_counts;
+			std::vector<XnInt32> m_heights;
+		};
+
+		// Projects depth frames of one sensor into an occupancy grid. Rows are split into 
+		// chunks that fill private partial grids in parallel; the partials are then merged.
+		// There is one partial per core, each the size of the whole grid (8 bytes per cell and
+		// layer), kept between frames. Only the cell rows a chunk touched are merged and cleared.
+		class OccupancyProjector
+		{
+		public:
+			OccupancyProjector();
+
+			void SetIntrinsics(const DepthIntrinsics& intrinsics) { m_intrinsics = intrinsics; }
+
+			// Transform from depth camera space (x right, y down, z forward) into the floor frame,
+			// where X and Z span the floor and Y is the height above it.
+			const RigidTransform& GetSensorToFloor() const { return m_sensorToFloor; }
+			void SetSensorToFloor(const RigidTransform& transform) { m_sensorToFloor = transform; }
+
+			// Builds the sensor to floor transform from a floor plane in OpenNI real world 
+			// coordinates (Y up). The floor origin is the point below the sensor.
+			void SetFloorPlane(const Vector3f& point, const Vector3f& normal);
+
+			// Height band (mm above the floor) of the points counted.
+			float GetMinHeight() const { return m_fMinHeight; }
+			float GetMaxHeight() const { return m_fMaxHeight; }
+			void SetHeightBand(float fMin, float fMax) { m_fMinHeight = fMin; m_fMaxHeight = fMax; }
+
+			// Uses every n-th pixel in both directions.
+			XnUInt32 GetPixelStep() const { return m_nPixelStep; }
+			void SetPixelStep(XnUInt32 nStep) { m_nPixelStep = (nStep == 0) ? 1 : nStep; }
+
+			// Projects the depth map (and optionally the label map of the same size) into the grid.
+			// Points of labels beyond the grid's last layer are skipped. Returns the number of points counted.
+			XnUInt32 Project(const XnUInt16* pDepth, const XnUInt16* pLabels, XnUInt32 nXRes, XnUInt32 nYRes, OccupancyGrid& grid);
+
+		private:
+			struct Partial
+			{
+				std::vector<XnUInt32> counts;
+				std::vector<XnInt32> heights;
+				std::vector<XnUInt8> touchedRows;	// per z row of each layer
+				XnUInt32 nPoints;
+			};
+
+			DepthIntrinsics m_intrinsics;
+			RigidTransform m_sensorToFloor;
+			float m_fMinHeight;
+			float m_fMaxHeight;
+			XnUInt32 m_nPixelStep;
+
+			std::vector<Partial> m_partials;
+		};
+	}
+}
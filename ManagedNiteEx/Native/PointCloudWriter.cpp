@@ -0,0 +1,225 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "PointCloudWriter.h"
+#include <stdio.h>
+#include <windows.h>
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		static const XnUInt32 PLY_RECORD_SIZE = 15;		// 3 floats and 3 bytes
+		static const XnUInt32 PCD_RECORD_SIZE = 16;		// 3 floats and packed rgb
+		static const XnUInt32 XYZ_RECORD_SIZE = 12;
+
+		// single WriteFile calls are kept below this size
+		static const XnUInt32 WRITE_CHUNK_SIZE = 8 * 1024 * 1024;
+
+		PointCloudWriter::PointCloudWriter(Format format)
+			: m_format(format), m_fScale(1.0f), m_nCurrent(0),
+			  m_bStreaming(false), m_pWriteTask(new Concurrency::task_group()),
+			  m_nStreamStatus(XN_STATUS_OK), m_nBytesWritten(0)
+		{
+			m_intrinsics = DepthIntrinsics::Create(575.8f, 320.0f, 240.0f);
+		}
+
+		PointCloudWriter::~PointCloudWriter()
+		{
+			WaitForWrite();
+			delete (Concurrency::task_group*)m_pWriteTask;
+		}
+
+		XnUInt32 PointCloudWriter::Convert(const XnUInt16* pDepth, const XnUInt8* pRgb, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nFrameID)
+		{
+			// a stream write may still read the current buffer
+			WaitForWrite();
+			return ConvertFrame(pDepth, pRgb, nXRes, nYRes, nFrameID);
+		}
+
+		XnUInt32 PointCloudWriter::ConvertFrame(const XnUInt16* pDepth, const XnUInt8* pRgb, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nFrameID)
+		{
+			std::vector<XnUInt8>& buffer = m_buffers[m_nCurrent];
+			buffer.clear();
+			if (pDepth == NULL || nXRes == 0 || nYRes == 0)
+				return 0;
+
+			// count valid pixels per row, then turn the counts into output offsets
+			m_rowOffsets.resize(nYRes + 1);
+			XnUInt32* pOffsets = &m_rowOffsets[0];
+			Concurrency::parallel_for(0, (int)nYRes, [&](int y)
+			{
+				const XnUInt16* pRow = pDepth + y * nXRes;
+				XnUInt32 nCount = 0;
+				for (XnUInt32 x = 0; x < nXRes; ++x)
+					nCount += (pRow[x] != 0);
+				pOffsets[y + 1] = nCount;
+			});
+
+			pOffsets[0] = 0;
+			for (XnUInt32 y = 0; y < nYRes; ++y)
+				pOffsets[y + 1] += pOffsets[y];
+			const XnUInt32 nPoints = pOffsets[nYRes];
+
+			const bool bColor = pRgb != NULL;
+			const XnUInt32 nRecordSize = !bColor ? XYZ_RECORD_SIZE : (m_format == FORMAT_PLY ? PLY_RECORD_SIZE : PCD_RECORD_SIZE);
+
+			char header[512];
+			int nHeader;
+			if (m_format == FORMAT_PLY)
+			{
+				nHeader = sprintf_s(header, sizeof(header),
+					"ply\nformat binary_little_endian 1.0\ncomment frame %u\nelement vertex %u\n"
+					"property float x\nproperty float y\nproperty float z\n%send_header\n",
+					nFrameID, nPoints,
+					bColor ? "property uchar red\nproperty uchar green\nproperty uchar blue\n" : "");
+			}
+			else
+			{
+				nHeader = sprintf_s(header, sizeof(header),
+					"# .PCD v0.7 - Point Cloud Data file format\nVERSION 0.7\n"
+					"FIELDS x y z%s\nSIZE 4 4 4%s\nTYPE F F F%s\nCOUNT 1 1 1%s\n"
+					"WIDTH %u\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS %u\nDATA binary\n",
+					bColor ? " rgb" : "", bColor ? " 4" : "", bColor ? " F" : "", bColor ? " 1" : "",
+					nPoints, nPoints);
+			}
+
+			buffer.resize(nHeader + (size_t)nPoints * nRecordSize);
+			memcpy(&buffer[0], header, nHeader);
+			XnUInt8* pBody = &buffer[0] + nHeader;
+
+			// real world coordinates (Y up) like ConvertProjectiveToRealWorld
+			const DepthIntrinsics in = m_intrinsics;
+			const float fScale = m_fScale;
+			const Format format = m_format;
+			Concurrency::parallel_for(0, (int)nYRes, [&](int y)
+			{
+				const XnUInt16* pRow = pDepth + y * nXRes;
+				const XnUInt8* pRgbRow = bColor ? pRgb + y * nXRes * 3 : NULL;
+				XnUInt8* pOut = pBody + (size_t)pOffsets[y] * nRecordSize;
+				float fRayY = (in.cy - y) / in.fy;
+
+				for (XnUInt32 x = 0; x < nXRes; ++x)
+				{
+					if (pRow[x] == 0)
+						continue;
+
+					float z = pRow[x];
+					float xyz[3] = { (x - in.cx) / in.fx * z * fScale, fRayY * z * fScale, z * fScale };
+					memcpy(pOut, xyz, sizeof(xyz));
+
+					if (bColor)
+					{
+						const XnUInt8* pPixel = pRgbRow + x * 3;
+						if (format == FORMAT_PLY)
+						{
+							pOut[12] = pPixel[0];
+							pOut[13] = pPixel[1];
+							pOut[14] = pPixel[2];
+						}
+						else
+						{
+							XnUInt32 rgb = ((XnUInt32)pPixel[0] << 16) | ((XnUInt32)pPixel[1] << 8) | pPixel[2];
+							memcpy(pOut + 12, &rgb, sizeof(rgb));
+						}
+					}
+					pOut += nRecordSize;
+				}
+			});
+
+			return nPoints;
+		}
+
+		XnStatus PointCloudWriter::WriteBuffer(const wchar_t* strPath, const std::vector<XnUInt8>& buffer)
+		{
+			HANDLE hFile = CreateFileW(strPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (hFile == INVALID_HANDLE_VALUE)
+				return XN_STATUS_OS_FILE_OPEN_FAILED;
+
+			XnStatus status = XN_STATUS_OK;
+			size_t nOffset = 0;
+			while (nOffset < buffer.size())
+			{
+				DWORD nChunk = (DWORD)((buffer.size() - nOffset < WRITE_CHUNK_SIZE) ? buffer.size() - nOffset : WRITE_CHUNK_SIZE);
+				DWORD nWritten = 0;
+				if (!WriteFile(hFile, &buffer[nOffset], nChunk, &nWritten, NULL) || nWritten != nChunk)
+				{
+					status = XN_STATUS_OS_FILE_WRITE_FAILED;
+					break;
+				}
+				nOffset += nWritten;
+			}
+
+			CloseHandle(hFile);
+			return status;
+		}
+
+		XnStatus PointCloudWriter::Write(const wchar_t* strPath)
+		{
+			WaitForWrite();
+			XnStatus status = WriteBuffer(strPath, m_buffers[m_nCurrent]);
+			if (status == XN_STATUS_OK)
+				m_nBytesWritten += m_buffers[m_nCurrent].size();
+			return status;
+		}
+
+		void PointCloudWriter::WaitForWrite()
+		{
+			((Concurrency::task_group*)m_pWriteTask)->wait();
+		}
+
+		XnStatus PointCloudWriter::BeginStream(const wchar_t* strDirectory, const wchar_t* strPrefix)
+		{
+			EndStream();
+
+			m_strDirectory = strDirectory;
+			if (!m_strDirectory.empty() && m_strDirectory[m_strDirectory.size() - 1] != L'\\')
+				m_strDirectory += L'\\';
+			m_strPrefix = strPrefix;
+			m_nStreamStatus = XN_STATUS_OK;
+			m_nBytesWritten = 0;
+			m_bStreaming = true;
+			return XN_STATUS_OK;
+		}
+
+		XnStatus PointCloudWriter::StreamFrame(const XnUInt16* pDepth, const XnUInt8* pRgb, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nFrameID, XnUInt32& nPoints)
+		{
+			nPoints = 0;
+			if (!m_bStreaming)
+				return XN_STATUS_INVALID_OPERATION;
+			if (m_nStreamStatus != XN_STATUS_OK)
+				return m_nStreamStatus;
+
+			// convert into the buffer that is not being written while the previous frame is written
+			m_nCurrent ^= 1;
+			nPoints = ConvertFrame(pDepth, pRgb, nXRes, nYRes, nFrameID);
+
+			WaitForWrite();
+			if (m_nStreamStatus != XN_STATUS_OK)
+				return m_nStreamStatus;
+
+			wchar_t strName[32];
+			swprintf_s(strName, 32, L"_%06u.", nFrameID);
+			std::wstring strPath = m_strDirectory + m_strPrefix + strName + GetExtension();
+
+			const std::vector<XnUInt8>* pBuffer = &m_buffers[m_nCurrent];
+			((Concurrency::task_group*)m_pWriteTask)->run([this, pBuffer, strPath]()
+			{
+				XnStatus status = WriteBuffer(strPath.c_str(), *pBuffer);
+				if (status == XN_STATUS_OK)
+					m_nBytesWritten += pBuffer->size();
+				else
+					m_nStreamStatus = status;
+			});
+
+			return XN_STATUS_OK;
+		}
+
+		XnStatus PointCloudWriter::EndStream()
+		{
+			WaitForWrite();
+			m_bStreaming = false;
+			return m_nStreamStatus;
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <XnOS.h>
+#include <string>
+#include <vector>
+#include "Geometry.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Converts depth (and registered RGB24) frames into binary PLY or PCD files.
+		// Invalid pixels are compacted away in parallel and each file is assembled in one
+		// buffer that is written with large sequential writes. In streaming mode the write 
+		// of a frame overlaps the conversion of the next one.
+		class PointCloudWriter
+		{
+		public:
+			enum Format
+			{
+				FORMAT_PLY = 0,
+				FORMAT_PCD = 1,
+			};
+
+			PointCloudWriter(Format format);
+			~PointCloudWriter();
+
+			Format GetFormat() const { return m_format; }
+			const wchar_t* GetExtension() const { return m_format == FORMAT_PLY ? L"ply" : L"pcd"; }
+
+			void SetIntrinsics(const DepthIntrinsics& intrinsics) { m_intrinsics = intrinsics; }
+
+			// Factor applied to real world coordinates (mm), e.g. 0.001 for meters.
+			float GetScale() const { return m_fScale; }
+			void SetScale(float fScale) { m_fScale = fScale; }
+
+			// Converts a frame into a complete file image. pRgb is optional and must match
+			// the depth resolution. Waits for a pending stream write first. Returns the number of points.
+			XnUInt32 Convert(const XnUInt16* pDepth, const XnUInt8* pRgb, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nFrameID);
+
+			const std::vector<XnUInt8>& GetBuffer() const { return m_buffers[m_nCurrent]; }
+
+			// Writes the last converted frame.
+			XnStatus Write(const wchar_t* strPath);
+
+			// Streams frames to <directory>\<prefix>_<frame id>.<extension>.
+			XnStatus BeginStream(const wchar_t* strDirectory, const wchar_t* strPrefix);
+			XnStatus StreamFrame(const XnUInt16* pDepth, const XnUInt8* pRgb, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nFrameID, XnUInt32& nPoints);
+			// Waits for the pending write. Returns the first write error of the stream.
+			XnStatus EndStream();
+			bool IsStreaming() const { return m_bStreaming; }
+
+			XnUInt64 GetBytesWritten() const { return m_nBytesWritten; }
+
+		private:
+			XnUInt32 ConvertFrame(const XnUInt16* pDepth, const XnUInt8* pRgb, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nFrameID);
+			static XnStatus WriteBuffer(const wchar_t* strPath, const std::vector<XnUInt8>& buffer);
+			void WaitForWrite();
+
+			Format m_format;
+			DepthIntrinsics m_intrinsics;
+			float m_fScale;
+
+			std::vector<XnUInt32> m_rowOffsets;
+			std::vector<XnUInt8> m_buffers[2];
+			XnUInt32 m_nCurrent;
+
+			bool m_bStreaming;
+			std::wstring m_strDirectory;
+			std::wstring m_strPrefix;
+			void* m_pWriteTask;		// Concurrency::task_group
+			volatile XnStatus m_nStreamStatus;
+			XnUInt64 m_nBytesWritten;
+		};
+	}
+}
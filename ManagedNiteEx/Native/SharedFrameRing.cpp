@@ -0,0 +1,403 @@
+// Native (non /clr) translation unit - Win32 file mapping and event objects.
+
+#include "SharedFrameRing.h"
+#include <windows.h>
+#include <string>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		static const XnUInt32 SHARED_RING_ALIGNMENT = 64;
+
+		static inline XnUInt32 AlignUp(XnUInt32 nValue)
+		{
+			return (nValue + SHARED_RING_ALIGNMENT - 1) & ~(SHARED_RING_ALIGNMENT - 1);
+		}
+
+		static std::wstring MappingName(const wchar_t* strName)
+		{
+			return std::wstring(L"Local\\ManagedNiteEx.") + strName;
+		}
+
+		static std::wstring EventName(const wchar_t* strName, XnUInt32 nParity)
+		{
+			return std::wstring(L"Local\\ManagedNiteEx.") + strName + (nParity == 0 ? L".Frame0" : L".Frame1");
+		}
+
+		static inline XnUInt32 SlotsOffset()
+		{
+			return AlignUp(sizeof(SharedRingHeader));
+		}
+
+		//---------------------------------------------------------------------------
+		// SharedFramePublisher
+		//---------------------------------------------------------------------------
+
+		SharedFramePublisher::SharedFramePublisher()
+			: m_hMapping(NULL), m_pHeader(NULL), m_nSequence(0)
+		{
+			m_hFrameEvents[0] = NULL;
+			m_hFrameEvents[1] = NULL;
+		}
+
+		SharedFramePublisher::~SharedFramePublisher()
+		{
+			Close();
+		}
+
+		XnStatus SharedFramePublisher::Create(const wchar_t* strName, XnUInt32 nSlotCount, const std::vector<xn::MapGenerator>& generators)
+		{
+			Close();
+
+			if (strName == NULL)
+				return XN_STATUS_NULL_INPUT_PTR;
+			if (nSlotCount < 2 || generators.empty() || generators.size() > SHARED_RING_MAX_STREAMS)
+				return XN_STATUS_BAD_PARAM;
+
+			m_generators = generators;
+			m_streamCapacity.resize(generators.size());
+
+			// slots are sized for the current output mode of every stream
+			XnUInt32 nSlotSize = AlignUp(sizeof(SharedSlotHeader));
+			for (size_t i = 0; i < m_generators.size(); ++i)
+			{
+				XnMapOutputMode mode;
+				m_generators[i].GetMapOutputMode(mode);
+				XnUInt32 nSize = mode.nXRes * mode.nYRes * m_generators[i].GetBytesPerPixel();
+				if (m_generators[i].GetDataSize() > nSize)
+					nSize = m_generators[i].GetDataSize();
+
+				m_streamCapacity[i] = AlignUp(nSize);
+				nSlotSize += m_streamCapacity[i];
+			}
+
+			XnUInt64 nTotalSize = (XnUInt64)SlotsOffset() + (XnUInt64)nSlotSize * nSlotCount;
+
+			m_hMapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 
+				(DWORD)(nTotalSize >> 32), (DWORD)(nTotalSize & 0xFFFFFFFF), MappingName(strName).c_str());
+			if (m_hMapping == NULL)
+				return XN_STATUS_ALLOC_FAILED;
+
+			// an existing section keeps its size and may belong to another publisher
+			if (GetLastError() == ERROR_ALREADY_EXISTS)
+			{
+				Close();
+				return XN_STATUS_INVALID_OPERATION;
+			}
+
+			m_pHeader = (SharedRingHeader*)MapViewOfFile(m_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+			m_hFrameEvents[0] = CreateEventW(NULL, TRUE, FALSE, EventName(strName, 0).c_str());
+			m_hFrameEvents[1] = CreateEventW(NULL, TRUE, FALSE, EventName(strName, 1).c_str());
+			if (m_pHeader == NULL || m_hFrameEvents[0] == NULL || m_hFrameEvents[1] == NULL)
+			{
+				Close();
+				return XN_STATUS_ALLOC_FAILED;
+			}
+
+			m_pHeader->nMagic = SHARED_RING_MAGIC;
+			m_pHeader->nVersion = SHARED_RING_VERSION;
+			m_pHeader->nSlotCount = nSlotCount;
+			m_pHeader->nSlotSize = nSlotSize;
+			m_pHeader->nLatestSequence = 0;
+			m_pHeader->nPublisherProcessId = GetCurrentProcessId();
+
+			for (XnUInt32 nSlot = 0; nSlot < nSlotCount; ++nSlot)
+			{
+				SharedSlotHeader* pSlot = (SharedSlotHeader*)((XnUInt8*)m_pHeader + SlotsOffset() + (size_t)nSlot * nSlotSize);
+				memset(pSlot, 0, sizeof(SharedSlotHeader));
+
+				XnUInt32 nDataOffset = AlignUp(sizeof(SharedSlotHeader));
+				for (size_t i = 0; i < m_generators.size(); ++i)
+				{
+					pSlot->streams[i].nNodeType = m_generators[i].GetInfo().GetDescription().Type;
+					pSlot->streams[i].nDataOffset = nDataOffset;
+					nDataOffset += m_streamCapacity[i];
+				}
+				pSlot->nStreamCount = (XnUInt32)m_generators.size();
+			}
+
+			m_nSequence = 0;
+			return XN_STATUS_OK;
+		}
+
+		void SharedFramePublisher::Close()
+		{
+			if (m_pHeader != NULL)
+			{
+				UnmapViewOfFile(m_pHeader);
+				m_pHeader = NULL;
+			}
+			if (m_hMapping != NULL)
+			{
+				CloseHandle(m_hMapping);
+				m_hMapping = NULL;
+			}
+			for (int i = 0; i < 2; ++i)
+			{
+				if (m_hFrameEvents[i] != NULL)
+				{
+					CloseHandle(m_hFrameEvents[i]);
+					m_hFrameEvents[i] = NULL;
+				}
+			}
+			m_generators.clear();
+			m_streamCapacity.clear();
+		}
+
+		XnStatus SharedFramePublisher::Publish()
+		{
+			if (m_pHeader == NULL)
+				return XN_STATUS_INVALID_OPERATION;
+
+			XnUInt32 nSequence = m_nSequence + 1;
+			SharedSlotHeader* pSlot = (SharedSlotHeader*)((XnUInt8*)m_pHeader + SlotsOffset() + 
+				(size_t)(nSequence % m_pHeader->nSlotCount) * m_pHeader->nSlotSize);
+
+			// subscribers that will have seen this frame block on the event of the next one
+			ResetEvent(m_hFrameEvents[(nSequence + 1) & 1]);
+
+			// odd version: slot is being written
+			InterlockedIncrement(&pSlot->nVersion);
+
+			for (size_t i = 0; i < m_generators.size(); ++i)
+			{
+				xn::MapGenerator& generator = m_generators[i];
+				SharedStreamHeader& stream = pSlot->streams[i];
+
+				XnMapOutputMode mode;
+				generator.GetMapOutputMode(mode);
+
+				stream.nFrameID = generator.GetFrameID();
+				stream.nTimestamp = generator.GetTimestamp();
+				stream.nFullXRes = mode.nXRes;
+				stream.nFullYRes = mode.nYRes;
+				stream.nFPS = mode.nFPS;
+				stream.nXRes = mode.nXRes;
+				stream.nYRes = mode.nYRes;
+				stream.nXOffset = 0;
+				stream.nYOffset = 0;
+
+				if (generator.IsCapabilitySupported(XN_CAPABILITY_CROPPING))
+				{
+					XnCropping cropping;
+					if (generator.GetCroppingCap().GetCropping(cropping) == XN_STATUS_OK && cropping.bEnabled)
+					{
+						stream.nXRes = cropping.nXSize;
+						stream.nYRes = cropping.nYSize;
+						stream.nXOffset = cropping.nXOffset;
+						stream.nYOffset = cropping.nYOffset;
+					}
+				}
+
+				if (stream.nNodeType == XN_NODE_TYPE_IMAGE)
+					stream.nPixelFormat = xn::ImageGenerator(generator.GetHandle()).GetPixelFormat();
+				else
+					stream.nPixelFormat = XN_PIXEL_FORMAT_GRAYSCALE_16_BIT;
+
+				// the only copy on the producer side, shared by all subscribers
+				XnUInt32 nDataSize = generator.GetDataSize();
+				if (nDataSize <= m_streamCapacity[i])
+				{
+					memcpy((XnUInt8*)pSlot + stream.nDataOffset, generator.GetData(), nDataSize);
+					stream.nDataSize = nDataSize;
+				}
+				else
+				{
+					// output mode grew after the ring was created
+					stream.nDataSize = 0;
+				}
+			}
+
+			pSlot->nSequence = (long)nSequence;
+
+			// even version: slot is consistent again
+			InterlockedIncrement(&pSlot->nVersion);
+
+			m_nSequence = nSequence;
+			InterlockedExchange(&m_pHeader->nLatestSequence, (long)nSequence);
+			SetEvent(m_hFrameEvents[nSequence & 1]);
+
+			return XN_STATUS_OK;
+		}
+
+		//---------------------------------------------------------------------------
+		// SharedFrameSubscriber
+		//---------------------------------------------------------------------------
+
+		SharedFrameSubscriber::SharedFrameSubscriber()
+			: m_hMapping(NULL), m_pHeader(NULL), m_pSlot(NULL), 
+			  m_nSlotVersion(0), m_nSequence(0), m_nSkipped(0)
+		{
+			m_hFrameEvents[0] = NULL;
+			m_hFrameEvents[1] = NULL;
+		}
+
+		SharedFrameSubscriber::~SharedFrameSubscriber()
+		{
+			Close();
+		}
+
+		XnStatus SharedFrameSubscriber::Open(const wchar_t* strName)
+		{
+			Close();
+
+			if (strName == NULL)
+				return XN_STATUS_NULL_INPUT_PTR;
+
+			m_hMapping = OpenFileMappingW(FILE_MAP_READ, FALSE, MappingName(strName).c_str());
+			if (m_hMapping == NULL)
+				return XN_STATUS_NO_MATCH;
+
+			m_pHeader = (SharedRingHeader*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+			m_hFrameEvents[0] = OpenEventW(SYNCHRONIZE, FALSE, EventName(strName, 0).c_str());
+			m_hFrameEvents[1] = OpenEventW(SYNCHRONIZE, FALSE, EventName(strName, 1).c_str());
+			if (m_pHeader == NULL || m_hFrameEvents[0] == NULL || m_hFrameEvents[1] == NULL || 
+				m_pHeader->nMagic != SHARED_RING_MAGIC || m_pHeader->nVersion != SHARED_RING_VERSION)
+			{
+				Close();
+				return XN_STATUS_NO_MATCH;
+			}
+
+			return XN_STATUS_OK;
+		}
+
+		void SharedFrameSubscriber::Close()
+		{
+			if (m_pHeader != NULL)
+			{
+				UnmapViewOfFile(m_pHeader);
+				m_pHeader = NULL;
+			}
+			if (m_hMapping != NULL)
+			{
+				CloseHandle(m_hMapping);
+				m_hMapping = NULL;
+			}
+			for (int i = 0; i < 2; ++i)
+			{
+				if (m_hFrameEvents[i] != NULL)
+				{
+					CloseHandle(m_hFrameEvents[i]);
+					m_hFrameEvents[i] = NULL;
+				}
+			}
+			m_pSlot = NULL;
+			m_nSequence = 0;
+			m_nSkipped = 0;
+		}
+
+		SharedSlotHeader* SharedFrameSubscriber::GetSlot(XnUInt32 nSequence) const
+		{
+			return (SharedSlotHeader*)((XnUInt8*)m_pHeader + SlotsOffset() + 
+				(size_t)(nSequence % m_pHeader->nSlotCount) * m_pHeader->nSlotSize);
+		}
+
+		XnStatus SharedFrameSubscriber::AcquireLatest(XnUInt32 nTimeoutMs)
+		{
+			if (m_pHeader == NULL)
+				return XN_STATUS_INVALID_OPERATION;
+
+			DWORD nStart = GetTickCount();
+			XnUInt32 nLatest = (XnUInt32)m_pHeader->nLatestSequence;
+			while (nLatest == 0 || nLatest == m_nSequence)
+			{
+				DWORD nWait = INFINITE;
+				if (nTimeoutMs != INFINITE)
+				{
+					DWORD nElapsed = GetTickCount() - nStart;
+					if (nElapsed >= nTimeoutMs)
+						return XN_STATUS_WAIT_DATA_TIMEOUT;
+					nWait = nTimeoutMs - nElapsed;
+				}
+
+				// the event of the next frame was reset before the current one was published.
+				// If the publisher got two frames ahead meanwhile, the wait lasts one more frame.
+				DWORD nResult = WaitForSingleObject(m_hFrameEvents[(nLatest + 1) & 1], nWait);
+				if (nResult == WAIT_FAILED)
+					return XN_STATUS_ERROR;
+
+				nLatest = (XnUInt32)m_pHeader->nLatestSequence;
+			}
+
+			for (XnUInt32 nRetry = 0; nRetry < SHARED_RING_MAX_READ_RETRIES; ++nRetry)
+			{
+				SharedSlotHeader* pSlot = GetSlot(nLatest);
+				long nVersion = pSlot->nVersion;
+				MemoryBarrier();
+
+				if ((nVersion & 1) == 0 && (XnUInt32)pSlot->nSequence == nLatest)
+				{
+					// slow readers jump straight to the newest frame set
+					if (m_nSequence != 0 && nLatest > m_nSequence + 1)
+						m_nSkipped += nLatest - m_nSequence - 1;
+
+					m_pSlot = pSlot;
+					m_nSlotVersion = nVersion;
+					m_nSequence = nLatest;
+					return XN_STATUS_OK;
+				}
+
+				// the publisher lapped us while we looked at the slot
+				YieldProcessor();
+				nLatest = (XnUInt32)m_pHeader->nLatestSequence;
+			}
+
+			return XN_STATUS_ERROR;
+		}
+
+		bool SharedFrameSubscriber::IsAcquiredValid() const
+		{
+			if (m_pSlot == NULL)
+				return false;
+
+			MemoryBarrier();
+			return m_pSlot->nVersion == m_nSlotVersion;
+		}
+
+		XnUInt32 SharedFrameSubscriber::GetStreamCount() const
+		{
+			return (m_pSlot == NULL) ? 0 : m_pSlot->nStreamCount;
+		}
+
+		const SharedStreamHeader* SharedFrameSubscriber::GetStream(XnUInt32 nIndex) const
+		{
+			if (m_pSlot == NULL || nIndex >= m_pSlot->nStreamCount)
+				return NULL;
+			return &m_pSlot->streams[nIndex];
+		}
+
+		const SharedStreamHeader* SharedFrameSubscriber::FindStream(XnUInt32 nNodeType) const
+		{
+			for (XnUInt32 i = 0; i < GetStreamCount(); ++i)
+			{
+				if (m_pSlot->streams[i].nNodeType == nNodeType)
+					return &m_pSlot->streams[i];
+			}
+			return NULL;
+		}
+
+		const XnUInt8* SharedFrameSubscriber::GetStreamData(const SharedStreamHeader* pStream) const
+		{
+			return (const XnUInt8*)m_pSlot + pStream->nDataOffset;
+		}
+
+		void SharedFrameSubscriber::FillMetaData(const SharedStreamHeader* pStream, xn::MapMetaData& metaData) const
+		{
+			metaData.Timestamp() = pStream->nTimestamp;
+			metaData.FrameID() = pStream->nFrameID;
+			metaData.DataSize() = pStream->nDataSize;
+			metaData.Data() = GetStreamData(pStream);
+			static_cast<xn::OutputMetaData&>(metaData).GetUnderlying()->bIsNew = TRUE;
+
+			metaData.XRes() = pStream->nXRes;
+			metaData.YRes() = pStream->nYRes;
+			metaData.XOffset() = pStream->nXOffset;
+			metaData.YOffset() = pStream->nYOffset;
+			metaData.FullXRes() = pStream->nFullXRes;
+			metaData.FullYRes() = pStream->nFullYRes;
+			metaData.FPS() = pStream->nFPS;
+			metaData.GetUnderlying()->PixelFormat = (XnPixelFormat)pStream->nPixelFormat;
+		}
+	}
+}
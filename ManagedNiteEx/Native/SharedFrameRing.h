@@ -0,0 +1,131 @@
+#pragma once
+
+#include <XnOS.h>
+#include <XnCppWrapper.h>
+#include <vector>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		static const XnUInt32 SHARED_RING_MAGIC = 0x524D4E58; // 'XNMR'
+		static const XnUInt32 SHARED_RING_VERSION = 2;
+		static const XnUInt32 SHARED_RING_MAX_STREAMS = 8;
+		// Attempts to read a consistent slot before giving up (the publisher died mid-write).
+		static const XnUInt32 SHARED_RING_MAX_READ_RETRIES = 1024;
+
+		// Describes one map stream inside a slot. Mirrors the fields of xn::MapMetaData.
+		struct SharedStreamHeader
+		{
+			XnUInt32 nNodeType;
+			XnUInt32 nFrameID;
+			XnUInt64 nTimestamp;
+			XnUInt32 nXRes;
+			XnUInt32 nYRes;
+			XnUInt32 nXOffset;
+			XnUInt32 nYOffset;
+			XnUInt32 nFullXRes;
+			XnUInt32 nFullYRes;
+			XnUInt32 nPixelFormat;
+			XnUInt32 nFPS;
+			XnUInt32 nDataOffset;	// from the start of the slot
+			XnUInt32 nDataSize;
+		};
+
+		// Slot header. nVersion is a sequence lock: odd while the publisher writes the slot.
+		struct SharedSlotHeader
+		{
+			volatile long nVersion;
+			volatile long nSequence;
+			XnUInt32 nStreamCount;
+			XnUInt32 nReserved;
+			SharedStreamHeader streams[SHARED_RING_MAX_STREAMS];
+		};
+
+		struct SharedRingHeader
+		{
+			XnUInt32 nMagic;
+			XnUInt32 nVersion;
+			XnUInt32 nSlotCount;
+			XnUInt32 nSlotSize;
+			volatile long nLatestSequence;	// 0 until the first frame set is published
+			XnUInt32 nPublisherProcessId;
+		};
+
+		// Shared memory (named file mapping) ring of frame sets written by one process 
+		// and mapped read-only by any number of subscribers. Each frame is copied once
+		// into a slot; subscribers read it in place.
+		// Frames are signaled with two manual reset events alternating by sequence parity:
+		// publishing frame n resets the event of frame n+1 and sets the event of frame n,
+		// so a subscriber that has seen frame n blocks on the event of frame n+1.
+		class SharedFramePublisher
+		{
+		public:
+			SharedFramePublisher();
+			~SharedFramePublisher();
+
+			// Creates the ring sized for the current output of the given map generators. Fails with
+			// XN_STATUS_INVALID_OPERATION while a ring of that name is still open anywhere.
+			XnStatus Create(const wchar_t* strName, XnUInt32 nSlotCount, const std::vector<xn::MapGenerator>& generators);
+			void Close();
+
+			bool IsOpen() const { return m_pHeader != NULL; }
+
+			// Copies the current data of every generator into the next slot and wakes subscribers.
+			XnStatus Publish();
+
+			XnUInt32 GetPublishedCount() const { return m_nSequence; }
+
+		private:
+			std::vector<xn::MapGenerator> m_generators;
+			std::vector<XnUInt32> m_streamCapacity;
+			void* m_hMapping;
+			void* m_hFrameEvents[2];
+			SharedRingHeader* m_pHeader;
+			XnUInt32 m_nSequence;
+		};
+
+		class SharedFrameSubscriber
+		{
+		public:
+			SharedFrameSubscriber();
+			~SharedFrameSubscriber();
+
+			XnStatus Open(const wchar_t* strName);
+			void Close();
+
+			bool IsOpen() const { return m_pHeader != NULL; }
+
+			// Acquires the newest published frame set, skipping any the reader was too slow for.
+			// Waits up to nTimeoutMs for a frame newer than the current one and returns
+			// XN_STATUS_WAIT_DATA_TIMEOUT when none arrived. Fails with XN_STATUS_ERROR
+			// when the newest slot stays inconsistent (the publisher stopped mid-write).
+			XnStatus AcquireLatest(XnUInt32 nTimeoutMs);
+
+			// True while the acquired slot has not been overwritten by the publisher.
+			bool IsAcquiredValid() const;
+
+			XnUInt32 GetSequence() const { return m_nSequence; }
+			XnUInt32 GetSkippedCount() const { return m_nSkipped; }
+
+			XnUInt32 GetStreamCount() const;
+			const SharedStreamHeader* GetStream(XnUInt32 nIndex) const;
+			const SharedStreamHeader* FindStream(XnUInt32 nNodeType) const;
+			const XnUInt8* GetStreamData(const SharedStreamHeader* pStream) const;
+
+			// Points the metadata at the stream data inside the mapping (no copy).
+			void FillMetaData(const SharedStreamHeader* pStream, xn::MapMetaData& metaData) const;
+
+		private:
+			SharedSlotHeader* GetSlot(XnUInt32 nSequence) const;
+
+			void* m_hMapping;
+			void* m_hFrameEvents[2];
+			SharedRingHeader* m_pHeader;
+			SharedSlotHeader* m_pSlot;
+			long m_nSlotVersion;
+			XnUInt32 m_nSequence;
+			XnUInt32 m_nSkipped;
+		};
+	}
+}
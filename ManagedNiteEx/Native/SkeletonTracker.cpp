@@ -0,0 +1,229 @@
+// Native (non /clr) translation unit.
+
+#include "SkeletonTracker.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		SkeletonTracker::SkeletonTracker(xn::UserGenerator& generator, XnUInt32 nMaxUsers)
+			: m_generator(generator), m_nMaxUsers(nMaxUsers), m_nUsers(0), m_nTimestamp(0), m_nFrameID(0),
+			  m_ids(nMaxUsers), m_users(nMaxUsers), m_joints(nMaxUsers * JOINT_COUNT),
+			  m_slotOwners(nMaxUsers, 0), m_slotFrames(nMaxUsers, 0),
+			  m_filter(nMaxUsers, JOINT_COUNT),
+			  m_bAutoTracking(false), m_bNeedPose(false),
+			  m_hUserCallbacks(NULL), m_hPoseCallbacks(NULL), m_hCalibrationCallbacks(NULL)
+		{
+			m_strPose[0] = '\0';
+		}
+
+		SkeletonTracker::~SkeletonTracker()
+		{
+			EnableAutoTracking(false);
+		}
+
+		XnUInt32 SkeletonTracker::GetSlot(XnUserID nUserId)
+		{
+			XnUInt32 nFree = m_nMaxUsers;
+			for (XnUInt32 i = 0; i < m_nMaxUsers; ++i)
+			{
+				if (m_slotOwners[i] == nUserId)
+					return i;
+				if (nFree == m_nMaxUsers && m_slotOwners[i] == 0)
+					nFree = i;
+			}
+
+			if (nFree < m_nMaxUsers)
+			{
+				m_slotOwners[nFree] = nUserId;
+				m_filter.ResetSlot(nFree);
+			}
+			return nFree;
+		}
+
+		XnUInt32 SkeletonTracker::Read()
+		{
+			JointFilter::ScopedLock guard(m_filter);
+
+			// the same frame must not be filtered twice
+			XnUInt32 nFrameID = m_generator.GetFrameID();
+			if (nFrameID == m_nFrameID && nFrameID != 0)
+				return m_nUsers;
+
+			XnUInt16 nUsers = (XnUInt16)m_nMaxUsers;
+			if (m_generator.GetUsers(&m_ids[0], nUsers) != XN_STATUS_OK)
+				nUsers = 0;
+
+			m_nUsers = nUsers;
+			m_nTimestamp = m_generator.GetTimestamp();
+			m_nFrameID = nFrameID;
+			XnDouble fTime = m_nTimestamp / 1e6;
+
+			bool bSkeleton = m_generator.IsCapabilitySupported(XN_CAPABILITY_SKELETON) == TRUE;
+			xn::SkeletonCapability skeleton = m_generator.GetSkeletonCap();
+
+			for (XnUInt32 u = 0; u < m_nUsers; ++u)
+			{
+				XnUserID nUserId = m_ids[u];
+				UserSkeleton& user = m_users[u];
+				SkeletonJoint* pJoints = &m_joints[u * JOINT_COUNT];
+
+				user.nUserId = nUserId;
+				user.nState = STATE_DETECTED;
+				if (m_generator.GetCoM(nUserId, user.centerOfMass) != XN_STATUS_OK)
+					memset(&user.centerOfMass, 0, sizeof(user.centerOfMass));
+
+				if (bSkeleton && skeleton.IsTracking(nUserId))
+				{
+					user.nState = STATE_TRACKING;
+					for (XnUInt32 j = 0; j < JOINT_COUNT; ++j)
+					{
+						XnSkeletonJointPosition position;
+						if (skeleton.GetSkeletonJointPosition(nUserId, (XnSkeletonJoint)(j + 1), position) == XN_STATUS_OK)
+						{
+							pJoints[j].X = position.position.X;
+							pJoints[j].Y = position.position.Y;
+							pJoints[j].Z = position.position.Z;
+							pJoints[j].fConfidence = position.fConfidence;
+						}
+						else
+						{
+							memset(&pJoints[j], 0, sizeof(SkeletonJoint));
+						}
+					}
+
+					XnUInt32 nSlot = GetSlot(nUserId);
+					if (nSlot < m_nMaxUsers)
+					{
+						m_filter.Apply(nSlot, pJoints, fTime);
+						m_slotFrames[nSlot] = m_nFrameID;
+					}
+				}
+				else
+				{
+					if (bSkeleton && skeleton.IsCalibrating(nUserId))
+						user.nState = STATE_CALIBRATING;
+					memset(pJoints, 0, JOINT_COUNT * sizeof(SkeletonJoint));
+				}
+			}
+
+			// release the filter state of users that are no longer tracked
+			for (XnUInt32 i = 0; i < m_nMaxUsers; ++i)
+			{
+				if (m_slotOwners[i] != 0 && m_slotFrames[i] != m_nFrameID)
+				{
+					m_slotOwners[i] = 0;
+					m_filter.ResetSlot(i);
+				}
+			}
+
+			return m_nUsers;
+		}
+
+		XnStatus SkeletonTracker::EnableAutoTracking(bool bEnable)
+		{
+			if (bEnable == m_bAutoTracking)
+				return XN_STATUS_OK;
+
+			if (!bEnable)
+			{
+				// a failed enable may have registered only some of the callbacks
+				if (m_hUserCallbacks != NULL)
+					m_generator.UnregisterUserCallbacks(m_hUserCallbacks);
+				if (m_hCalibrationCallbacks != NULL)
+					m_generator.GetSkeletonCap().UnregisterCalibrationCallbacks(m_hCalibrationCallbacks);
+				if (m_hPoseCallbacks != NULL)
+					m_generator.GetPoseDetectionCap().UnregisterFromPoseCallbacks(m_hPoseCallbacks);
+
+				m_hUserCallbacks = m_hCalibrationCallbacks = m_hPoseCallbacks = NULL;
+				m_bAutoTracking = false;
+				return XN_STATUS_OK;
+			}
+
+			if (!m_generator.IsCapabilitySupported(XN_CAPABILITY_SKELETON))
+				return XN_STATUS_INVALID_OPERATION;
+
+			xn::SkeletonCapability skeleton = m_generator.GetSkeletonCap();
+			m_bNeedPose = skeleton.NeedPoseForCalibration() == TRUE;
+			if (m_bNeedPose)
+			{
+				if (!m_generator.IsCapabilitySupported(XN_CAPABILITY_POSE_DETECTION))
+					return XN_STATUS_INVALID_OPERATION;
+
+				skeleton.GetCalibrationPose(m_strPose);
+				XnStatus status = m_generator.GetPoseDetectionCap().RegisterToPoseCallbacks(OnPoseDetected, NULL, this, m_hPoseCallbacks);
+				if (status != XN_STATUS_OK)
+					return status;
+			}
+
+			XnStatus status = m_generator.RegisterUserCallbacks(OnNewUser, OnLostUser, this, m_hUserCallbacks);
+			if (status == XN_STATUS_OK)
+				status = skeleton.RegisterCalibrationCallbacks(OnCalibrationStart, OnCalibrationEnd, this, m_hCalibrationCallbacks);
+
+			m_bAutoTracking = true;
+			if (status != XN_STATUS_OK)
+			{
+				EnableAutoTracking(false);
+				return status;
+			}
+
+			// users already in the scene
+			XnUInt16 nUsers = (XnUInt16)m_nMaxUsers;
+			if (m_generator.GetUsers(&m_ids[0], nUsers) == XN_STATUS_OK)
+			{
+				for (XnUInt16 i = 0; i < nUsers; ++i)
+				{
+					if (!skeleton.IsTracking(m_ids[i]) && !skeleton.IsCalibrating(m_ids[i]))
+						RequestCalibration(m_ids[i]);
+				}
+			}
+			return XN_STATUS_OK;
+		}
+
+		void SkeletonTracker::RequestCalibration(XnUserID nUserId)
+		{
+			if (m_bNeedPose)
+				m_generator.GetPoseDetectionCap().StartPoseDetection(m_strPose, nUserId);
+			else
+				m_generator.GetSkeletonCap().RequestCalibration(nUserId, TRUE);
+		}
+
+		void XN_CALLBACK_TYPE SkeletonTracker::OnNewUser(xn::UserGenerator& /*generator*/, XnUserID nUserId, void* pCookie)
+		{
+			((SkeletonTracker*)pCookie)->RequestCalibration(nUserId);
+		}
+
+		void XN_CALLBACK_TYPE SkeletonTracker::OnLostUser(xn::UserGenerator& /*generator*/, XnUserID nUserId, void* pCookie)
+		{
+			SkeletonTracker* pThis = (SkeletonTracker*)pCookie;
+			JointFilter::ScopedLock guard(pThis->m_filter);
+			for (XnUInt32 i = 0; i < pThis->m_nMaxUsers; ++i)
+			{
+				if (pThis->m_slotOwners[i] == nUserId)
+				{
+					pThis->m_slotOwners[i] = 0;
+					pThis->m_filter.ResetSlot(i);
+				}
+			}
+		}
+
+		void XN_CALLBACK_TYPE SkeletonTracker::OnPoseDetected(xn::PoseDetectionCapability& pose, const XnChar* /*strPose*/, XnUserID nUserId, void* pCookie)
+		{
+			SkeletonTracker* pThis = (SkeletonTracker*)pCookie;
+			pose.StopPoseDetection(nUserId);
+			pThis->m_generator.GetSkeletonCap().RequestCalibration(nUserId, TRUE);
+		}
+
+		void XN_CALLBACK_TYPE SkeletonTracker::OnCalibrationStart(xn::SkeletonCapability& /*skeleton*/, XnUserID /*nUserId*/, void* /*pCookie*/)
+		{
+		}
+
+		void XN_CALLBACK_TYPE SkeletonTracker::OnCalibrationEnd(xn::SkeletonCapability& skeleton, XnUserID nUserId, XnBool bSuccess, void* pCookie)
+		{
+			if (bSuccess)
+				skeleton.StartTracking(nUserId);
+			else
+				((SkeletonTracker*)pCookie)->RequestCalibration(nUserId);
+		}
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <XnOS.h>
+#include <XnCppWrapper.h>
+#include <vector>
+#include "JointFilter.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Per-user record of a skeleton frame, layout compatible with XnMUserSkeleton
+		struct UserSkeleton
+		{
+			XnUInt32 nUserId;
+			XnUInt32 nState;		// SkeletonTracker::STATE_*
+			XnPoint3D centerOfMass;
+		};
+
+		// Reads the skeletons of all users of a user generator in one call into preallocated
+		// arrays (JOINT_COUNT joints per user, indexed by XnSkeletonJoint - 1), smoothing the
+		// joints on the way. Optionally drives calibration and tracking of new users.
+		// Read and the lost-user callback, which runs on the threads that update the context,
+		// share the filter lock for the filter slots.
+		class SkeletonTracker
+		{
+		public:
+			static const XnUInt32 JOINT_COUNT = XN_SKEL_RIGHT_FOOT;
+
+			enum State
+			{
+				STATE_DETECTED = 0,
+				STATE_CALIBRATING = 1,
+				STATE_TRACKING = 2,
+			};
+
+			SkeletonTracker(xn::UserGenerator& generator, XnUInt32 nMaxUsers);
+			~SkeletonTracker();
+
+			// Reads the current frame of the generator. Returns the number of users.
+			XnUInt32 Read();
+
+			XnUInt32 GetMaxUsers() const { return m_nMaxUsers; }
+			XnUInt32 GetUserCount() const { return m_nUsers; }
+			XnUInt64 GetTimestamp() const { return m_nTimestamp; }
+			XnUInt32 GetFrameID() const { return m_nFrameID; }
+			const UserSkeleton* GetUsers() const { return &m_users[0]; }
+			const SkeletonJoint* GetJoints() const { return &m_joints[0]; }
+
+			JointFilter& GetFilter() { return m_filter; }
+
+			// Requests calibration of new users (through pose detection when the skeleton 
+			// needs a pose) and starts tracking them once calibrated.
+			XnStatus EnableAutoTracking(bool bEnable);
+			bool IsAutoTracking() const { return m_bAutoTracking; }
+
+		private:
+			XnUInt32 GetSlot(XnUserID nUserId);
+
+			static void XN_CALLBACK_TYPE OnNewUser(xn::UserGenerator& generator, XnUserID nUserId, void* pCookie);
+			static void XN_CALLBACK_TYPE OnLostUser(xn::UserGenerator& generator, XnUserID nUserId, void* pCookie);
+			static void XN_CALLBACK_TYPE OnPoseDetected(xn::PoseDetectionCapability& pose, const XnChar* strPose, XnUserID nUserId, void* pCookie);
+			static void XN_CALLBACK_TYPE OnCalibrationStart(xn::SkeletonCapability& skeleton, XnUserID nUserId, void* pCookie);
+			static void XN_CALLBACK_TYPE OnCalibrationEnd(xn::SkeletonCapability& skeleton, XnUserID nUserId, XnBool bSuccess, void* pCookie);
+
+			void RequestCalibration(XnUserID nUserId);
+
+			xn::UserGenerator m_generator;
+			XnUInt32 m_nMaxUsers;
+			XnUInt32 m_nUsers;
+			XnUInt64 m_nTimestamp;
+			XnUInt32 m_nFrameID;
+
+			std::vector<XnUserID> m_ids;
+			std::vector<UserSkeleton> m_users;
+			std::vector<SkeletonJoint> m_joints;
+
+			// filter slot owned by each user id (0 = free)
+			std::vector<XnUserID> m_slotOwners;
+			std::vector<XnUInt32> m_slotFrames;
+			JointFilter m_filter;
+
+			bool m_bAutoTracking;
+			bool m_bNeedPose;
+			XnChar m_strPose[20];
+			XnCallbackHandle m_hUserCallbacks;
+			XnCallbackHandle m_hPoseCallbacks;
+			XnCallbackHandle m_hCalibrationCallbacks;
+		};
+	}
+}
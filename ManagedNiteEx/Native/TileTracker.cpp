@@ -0,0 +1,198 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime.
+
+#include "TileTracker.h"
+#include "CpuDispatch.h"
+#include <ppl.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		TileTracker::TileTracker(XnUInt32 nTileSize, XnUInt32 nDepthTolerance, XnUInt32 nColorTolerance)
+			: m_nTileSize(nTileSize == 0 ? 16 : nTileSize),
+			  m_nDepthTolerance(nDepthTolerance),
+			  m_nColorTolerance(nColorTolerance),
+			  m_nXRes(0), m_nYRes(0), m_nBytesPerPixel(0),
+			  m_nTilesX(0), m_nTilesY(0), m_nDirtyTiles(0),
+			  m_bHasReference(false)
+		{
+		}
+
+		void TileTracker::Reset()
+		{
+			m_bHasReference = false;
+		}
+
+		bool TileTracker::IsTileDirty(XnUInt32 nTileX, XnUInt32 nTileY) const
+		{
+			if (nTileX >= m_nTilesX || nTileY >= m_nTilesY)
+				return false;
+			return m_mask[nTileY * m_nTilesX + nTileX] != 0;
+		}
+
+		XnUInt32 TileTracker::Update(const void* pData, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nBytesPerPixel)
+		{
+			if (pData == NULL || nXRes == 0 || nYRes == 0 || nBytesPerPixel == 0)
+			{
+				m_rects.clear();
+				m_nDirtyTiles = 0;
+				return 0;
+			}
+
+			// a change of geometry invalidates the reference frame
+			if (nXRes != m_nXRes || nYRes != m_nYRes || nBytesPerPixel != m_nBytesPerPixel)
+			{
+				m_nXRes = nXRes;
+				m_nYRes = nYRes;
+				m_nBytesPerPixel = nBytesPerPixel;
+				m_nTilesX = (nXRes + m_nTileSize - 1) / m_nTileSize;
+				m_nTilesY = (nYRes + m_nTileSize - 1) / m_nTileSize;
+				m_previous.resize((size_t)nXRes * nYRes * nBytesPerPixel);
+				m_mask.resize((size_t)m_nTilesX * m_nTilesY);
+				m_bHasReference = false;
+			}
+
+			const XnUInt8* pBytes = (const XnUInt8*)pData;
+
+			if (!m_bHasReference)
+			{
+				memset(&m_mask[0], 1, m_mask.size());
+				memcpy(&m_previous[0], pBytes, m_previous.size());
+				m_bHasReference = true;
+			}
+			else
+			{
+				memset(&m_mask[0], 0, m_mask.size());
+				Concurrency::parallel_for(0, (int)m_nTilesY, [&](int nTileY)
+				{
+					CompareTileRow((XnUInt32)nTileY, pBytes);
+				});
+			}
+
+			BuildRects();
+			return (XnUInt32)m_rects.size();
+		}
+
+		void TileTracker::CompareTileRow(XnUInt32 nTileY, const XnUInt8* pData)
+		{
+			const XnUInt32 nStride = m_nXRes * m_nBytesPerPixel;
+			const XnUInt32 nFirstRow = nTileY * m_nTileSize;
+			const XnUInt32 nLastRow = (nFirstRow + m_nTileSize < m_nYRes) ? nFirstRow + m_nTileSize : m_nYRes;
+			XnUInt8* pMask = &m_mask[nTileY * m_nTilesX];
+			const CpuKernels& kernels = CpuDispatch::GetKernels();
+
+			for (XnUInt32 y = nFirstRow; y < nLastRow; ++y)
+			{
+				const XnUInt8* pCurRow = pData + (size_t)y * nStride;
+				XnUInt8* pPrevRow = &m_previous[(size_t)y * nStride];
+
+				for (XnUInt32 tx = 0; tx < m_nTilesX; ++tx)
+				{
+					if (pMask[tx])
+						continue;
+
+					XnUInt32 nFirstCol = tx * m_nTileSize;
+					XnUInt32 nCols = (nFirstCol + m_nTileSize < m_nXRes) ? m_nTileSize : m_nXRes - nFirstCol;
+					size_t nOffset = (size_t)nFirstCol * m_nBytesPerPixel;
+					size_t nBytes = (size_t)nCols * m_nBytesPerPixel;
+
+					// exact comparison is the common (label map) case and memcmp is the fastest path
+					if (memcmp(pCurRow + nOffset, pPrevRow + nOffset, nBytes) == 0)
+						continue;
+
+					bool bChanged;
+					if (m_nBytesPerPixel == 2)
+						bChanged = kernels.pSpanChanged16((const XnUInt16*)(pCurRow + nOffset), (const XnUInt16*)(pPrevRow + nOffset), nCols, m_nDepthTolerance);
+					else
+						bChanged = kernels.pSpanChanged8(pCurRow + nOffset, pPrevRow + nOffset, (XnUInt32)nBytes, m_nColorTolerance);
+
+					if (bChanged)
+						pMask[tx] = 1;
+				}
+			}
+
+			// only dirty tiles become the new reference, so slow drifts below the
+			// tolerance still accumulate until they are reported
+			for (XnUInt32 tx = 0; tx < m_nTilesX; ++tx)
+			{
+				if (!pMask[tx])
+					continue;
+
+				XnUInt32 nFirstCol = tx * m_nTileSize;
+				XnUInt32 nCols = (nFirstCol + m_nTileSize < m_nXRes) ? m_nTileSize : m_nXRes - nFirstCol;
+				size_t nOffset = (size_t)nFirstCol * m_nBytesPerPixel;
+				size_t nBytes = (size_t)nCols * m_nBytesPerPixel;
+
+				for (XnUInt32 y = nFirstRow; y < nLastRow; ++y)
+				{
+					memcpy(&m_previous[(size_t)y * nStride + nOffset], pData + (size_t)y * nStride + nOffset, nBytes);
+				}
+			}
+		}
+
+		void TileTracker::BuildRects()
+		{
+			m_rects.clear();
+			m_nDirtyTiles = 0;
+
+			// rectangles that ended on the previous tile row and can still grow downwards
+			size_t nPrevRowBegin = 0;
+			size_t nPrevRowEnd = 0;
+
+			for (XnUInt32 ty = 0; ty < m_nTilesY; ++ty)
+			{
+				const XnUInt8* pMask = &m_mask[ty * m_nTilesX];
+				size_t nRowBegin = m_rects.size();
+				XnUInt32 nRowY = ty * m_nTileSize;
+				XnUInt32 nRowHeight = (nRowY + m_nTileSize < m_nYRes) ? m_nTileSize : m_nYRes - nRowY;
+
+				XnUInt32 tx = 0;
+				while (tx < m_nTilesX)
+				{
+					if (!pMask[tx])
+					{
+						++tx;
+						continue;
+					}
+
+					// horizontal run of dirty tiles
+					XnUInt32 nRunStart = tx;
+					while (tx < m_nTilesX && pMask[tx])
+						++tx;
+					m_nDirtyTiles += tx - nRunStart;
+
+					XnUInt32 nX = nRunStart * m_nTileSize;
+					XnUInt32 nRight = (tx * m_nTileSize < m_nXRes) ? tx * m_nTileSize : m_nXRes;
+
+					// extend a rectangle of the previous row spanning exactly the same columns
+					bool bMerged = false;
+					for (size_t i = nPrevRowBegin; i < nPrevRowEnd; ++i)
+					{
+						DirtyRect& prev = m_rects[i];
+						if (prev.X == nX && prev.Width == nRight - nX && prev.Y + prev.Height == nRowY)
+						{
+							prev.Height += nRowHeight;
+							// keep the grown rectangle available to the next row
+							DirtyRect grown = prev;
+							m_rects.erase(m_rects.begin() + i);
+							--nPrevRowEnd;
+							--nRowBegin;
+							m_rects.push_back(grown);
+							bMerged = true;
+							break;
+						}
+					}
+
+					if (!bMerged)
+					{
+						DirtyRect rect = { nX, nRowY, nRight - nX, nRowHeight };
+						m_rects.push_back(rect);
+					}
+				}
+
+				nPrevRowBegin = nRowBegin;
+				nPrevRowEnd = m_rects.size();
+			}
+		}
+	}
+}
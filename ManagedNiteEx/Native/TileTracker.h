@@ -0,0 +1,71 @@
+#pragma once
+
+#include <XnOS.h>
+#include <vector>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Rectangle in map pixel coordinates (before applying crop offsets)
+		struct DirtyRect
+		{
+			XnUInt32 X;
+			XnUInt32 Y;
+			XnUInt32 Width;
+			XnUInt32 Height;
+		};
+
+		// Tracks which fixed-size tiles of a pixel map changed since the previous frame.
+		// 16-bit maps (depth, labels) are compared with the depth tolerance, 8-bit channel
+		// maps (RGB24, grayscale) with the color tolerance.
+		class TileTracker
+		{
+		public:
+			TileTracker(XnUInt32 nTileSize, XnUInt32 nDepthTolerance, XnUInt32 nColorTolerance);
+
+			// Compares the map against the previous one, stores it as the new reference
+			// and rebuilds the dirty rectangle list. Returns the number of dirty rectangles.
+			XnUInt32 Update(const void* pData, XnUInt32 nXRes, XnUInt32 nYRes, XnUInt32 nBytesPerPixel);
+
+			// Forgets the reference frame so the next update marks every tile as dirty.
+			void Reset();
+
+			XnUInt32 GetTileSize() const { return m_nTileSize; }
+			XnUInt32 GetTilesX() const { return m_nTilesX; }
+			XnUInt32 GetTilesY() const { return m_nTilesY; }
+
+			XnUInt32 GetDepthTolerance() const { return m_nDepthTolerance; }
+			void SetDepthTolerance(XnUInt32 nTolerance) { m_nDepthTolerance = nTolerance; }
+
+			XnUInt32 GetColorTolerance() const { return m_nColorTolerance; }
+			void SetColorTolerance(XnUInt32 nTolerance) { m_nColorTolerance = nTolerance; }
+
+			bool IsTileDirty(XnUInt32 nTileX, XnUInt32 nTileY) const;
+			XnUInt32 GetDirtyTileCount() const { return m_nDirtyTiles; }
+
+			XnUInt32 GetDirtyRectCount() const { return (XnUInt32)m_rects.size(); }
+			const DirtyRect* GetDirtyRects() const { return m_rects.empty() ? NULL : &m_rects[0]; }
+
+		private:
+			void CompareTileRow(XnUInt32 nTileY, const XnUInt8* pData);
+			void BuildRects();
+
+			XnUInt32 m_nTileSize;
+			XnUInt32 m_nDepthTolerance;
+			XnUInt32 m_nColorTolerance;
+
+			XnUInt32 m_nXRes;
+			XnUInt32 m_nYRes;
+			XnUInt32 m_nBytesPerPixel;
+			XnUInt32 m_nTilesX;
+			XnUInt32 m_nTilesY;
+			XnUInt32 m_nDirtyTiles;
+			bool m_bHasReference;
+
+			std::vector<XnUInt8> m_previous;
+			std::vector<XnUInt8> m_mask;
+			std::vector<DirtyRect> m_rects;
+		};
+	}
+}
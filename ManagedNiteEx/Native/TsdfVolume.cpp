@@ -0,0 +1,650 @@
+// Native (non /clr) translation unit - uses the Concurrency Runtime and SSE2 intrinsics.
+
+#include "TsdfVolume.h"
+#include <algorithm>
+#include <ppl.h>
+#include <emmintrin.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		static const XnInt32 KEY_OFFSET = 1 << 20;
+		static const float TSDF_SCALE = 32767.0f;
+
+		static inline XnUInt64 PackKey(XnInt32 x, XnInt32 y, XnInt32 z)
+		{
+			return ((XnUInt64)((x + KEY_OFFSET) & 0x1FFFFF) << 42) |
+				   ((XnUInt64)((y + KEY_OFFSET) & 0x1FFFFF) << 21) |
+				    (XnUInt64)((z + KEY_OFFSET) & 0x1FFFFF);
+		}
+
+		static inline void UnpackKey(XnUInt64 key, XnInt32& x, XnInt32& y, XnInt32& z)
+		{
+			x = (XnInt32)((key >> 42) & 0x1FFFFF) - KEY_OFFSET;
+			y = (XnInt32)((key >> 21) & 0x1FFFFF) - KEY_OFFSET;
+			z = (XnInt32)(key & 0x1FFFFF) - KEY_OFFSET;
+		}
+
+		static inline XnUInt32 HashKey(XnUInt64 key)
+		{
+			return (XnUInt32)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+		}
+
+		static inline XnInt32 FloorDiv(XnInt32 a, XnInt32 b)
+		{
+			return (a >= 0) ? a / b : -((-a + b - 1) / b);
+		}
+
+		static inline XnInt32 FloorToInt(float f)
+		{
+			return (XnInt32)floorf(f);
+		}
+
+		static inline Vector3f Interpolate(const Vector3f& a, const Vector3f& b, float fa, float fb)
+		{
+			float t = fa / (fa - fb);
+			return a + (b - a) * t;
+		}
+
+		static void EmitTriangle(std::vector<float>& out, const Vector3f& a, Vector3f b, Vector3f c, const Vector3f& outward)
+		{
+			// wind triangles so that their normal points out of the surface (towards positive distance)
+			if (Dot(Cross(b - a, c - a), outward) < 0.0f)
+			{
+				Vector3f tmp = b;
+				b = c;
+				c = tmp;
+			}
+
+			out.push_back(a.x); out.push_back(a.y); out.push_back(a.z);
+			out.push_back(b.x); out.push_back(b.y); out.push_back(b.z);
+			out.push_back(c.x); out.push_back(c.y); out.push_back(c.z);
+		}
+
+		// Marching tetrahedra on one of the six tetrahedra of a cell
+		static void PolygonizeTetrahedron(const Vector3f* p, const float* f, std::vector<float>& out)
+		{
+			int inside[4], outside[4];
+			int nInside = 0, nOutside = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				if (f[i] < 0.0f)
+					inside[nInside++] = i;
+				else
+					outside[nOutside++] = i;
+			}
+
+			if (nInside == 0 || nOutside == 0)
+				return;
+
+			Vector3f centerIn = MakeVector3f(0, 0, 0);
+			Vector3f centerOut = MakeVector3f(0, 0, 0);
+			for (int i = 0; i < nInside; ++i)
+				centerIn = centerIn + p[inside[i]];
+			for (int i = 0; i < nOutside; ++i)
+				centerOut = centerOut + p[outside[i]];
+			Vector3f outward = centerOut * (1.0f / nOutside) - centerIn * (1.0f / nInside);
+
+			if (nInside == 1 || nOutside == 1)
+			{
+				// one vertex separated from the other three
+				int a = (nInside == 1) ? inside[0] : outside[0];
+				const int* others = (nInside == 1) ? outside : inside;
+
+				EmitTriangle(out,
+					Interpolate(p[a], p[others[0]], f[a], f[others[0]]),
+					Interpolate(p[a], p[others[1]], f[a], f[others[1]]),
+					Interpolate(p[a], p[others[2]], f[a], f[others[2]]),
+					outward);
+			}
+			else
+			{
+				// two and two: the crossing is a quad
+				int i0 = inside[0], i1 = inside[1], o0 = outside[0], o1 = outside[1];
+				Vector3f q0 = Interpolate(p[i0], p[o0], f[i0], f[o0]);
+				Vector3f q1 = Interpolate(p[i0], p[o1], f[i0], f[o1]);
+				Vector3f q2 = Interpolate(p[i1], p[o1], f[i1], f[o1]);
+				Vector3f q3 = Interpolate(p[i1], p[o0], f[i1], f[o0]);
+
+				EmitTriangle(out, q0, q1, q2, outward);
+				EmitTriangle(out, q0, q2, q3, outward);
+			}
+		}
+
+		TsdfVolume::TsdfVolume(float fVoxelSize, float fTruncation, XnUInt32 nMaxBlocks)
+			: m_fVoxelSize(fVoxelSize > 0 ? fVoxelSize : 10.0f),
+			  m_fTruncation(fTruncation > 0 ? fTruncation : 4 * m_fVoxelSize),
+			  m_fMinRange(400.0f),
+			  m_fMaxRange(4000.0f),
+			  m_nMaxBlocks(nMaxBlocks > 0 ? nMaxBlocks : 16384),
+			  m_nDroppedBlocks(0),
+			  m_nFrameStamp(0)
+		{
+			XnUInt32 nTableSize = 1;
+			while (nTableSize < m_nMaxBlocks * 2)
+				nTableSize <<= 1;
+
+			m_table.assign(nTableSize, -1);
+			m_nTableMask = nTableSize - 1;
+			m_blocks.reserve(m_nMaxBlocks);
+		}
+
+		TsdfVolume::~TsdfVolume()
+		{
+			Reset();
+		}
+
+		void TsdfVolume::Reset()
+		{
+			for (size_t i = 0; i < m_blocks.size(); ++i)
+			{
+				delete m_blocks[i];
+			}
+			m_blocks.clear();
+			m_blockMeshes.clear();
+			m_visibleBlocks.clear();
+			m_updatedBlocks.clear();
+			std::fill(m_table.begin(), m_table.end(), -1);
+			m_nDroppedBlocks = 0;
+		}
+
+		XnInt32 TsdfVolume::FindBlock(XnInt32 x, XnInt32 y, XnInt32 z) const
+		{
+			XnUInt32 nSlot = HashKey(PackKey(x, y, z)) & m_nTableMask;
+			for (;;)
+			{
+				XnInt32 nIndex = m_table[nSlot];
+				if (nIndex < 0)
+					return -1;
+
+				const Block* pBlock = m_blocks[nIndex];
+				if (pBlock->x == x && pBlock->y == y && pBlock->z == z)
+					return nIndex;
+
+				nSlot = (nSlot + 1) & m_nTableMask;
+			}
+		}
+
+		XnInt32 TsdfVolume::FindOrAllocateBlock(XnInt32 x, XnInt32 y, XnInt32 z)
+		{
+			XnUInt32 nSlot = HashKey(PackKey(x, y, z)) & m_nTableMask;
+			for (;;)
+			{
+				XnInt32 nIndex = m_table[nSlot];
+				if (nIndex < 0)
+					break;
+
+				const Block* pBlock = m_blocks[nIndex];
+				if (pBlock->x == x && pBlock->y == y && pBlock->z == z)
+					return nIndex;
+
+				nSlot = (nSlot + 1) & m_nTableMask;
+			}
+
+			// memory budget exhausted
+			if (m_blocks.size() >= m_nMaxBlocks)
+				return -1;
+
+			Block* pBlock = new Block();
+			pBlock->x = x;
+			pBlock->y = y;
+			pBlock->z = z;
+
+			XnInt32 nIndex = (XnInt32)m_blocks.size();
+			m_blocks.push_back(pBlock);
+			m_table[nSlot] = nIndex;
+			return nIndex;
+		}
+
+		const TsdfVolume::Voxel* TsdfVolume::GetVoxel(XnInt32 x, XnInt32 y, XnInt32 z) const
+		{
+			XnInt32 bx = FloorDiv(x, BLOCK_SIZE);
+			XnInt32 by = FloorDiv(y, BLOCK_SIZE);
+			XnInt32 bz = FloorDiv(z, BLOCK_SIZE);
+
+			XnInt32 nBlock = FindBlock(bx, by, bz);
+			if (nBlock < 0)
+				return NULL;
+
+			XnInt32 lx = x - bx * BLOCK_SIZE;
+			XnInt32 ly = y - by * BLOCK_SIZE;
+			XnInt32 lz = z - bz * BLOCK_SIZE;
+			return &m_blocks[nBlock]->voxels[(lz * BLOCK_SIZE + ly) * BLOCK_SIZE + lx];
+		}
+
+		bool TsdfVolume::SampleTsdf(const Vector3f& world, float& fTsdf) const
+		{
+			float fInv = 1.0f / m_fVoxelSize;
+			const Voxel* pVoxel = GetVoxel(FloorToInt(world.x * fInv + 0.5f), FloorToInt(world.y * fInv + 0.5f), FloorToInt(world.z * fInv + 0.5f));
+			if (pVoxel == NULL || pVoxel->nWeight == 0)
+				return false;
+
+			fTsdf = pVoxel->nTsdf / TSDF_SCALE;
+			return true;
+		}
+
+		bool TsdfVolume::IsBlockAllocated(const Vector3f& world) const
+		{
+			float fInv = 1.0f / (m_fVoxelSize * BLOCK_SIZE);
+			return FindBlock(FloorToInt(world.x * fInv), FloorToInt(world.y * fInv), FloorToInt(world.z * fInv)) >= 0;
+		}
+
+		bool TsdfVolume::SampleTsdfTrilinear(const Vector3f& world, float& fTsdf) const
+		{
+			float fInv = 1.0f / m_fVoxelSize;
+			float gx = world.x * fInv, gy = world.y * fInv, gz = world.z * fInv;
+			XnInt32 x0 = FloorToInt(gx), y0 = FloorToInt(gy), z0 = FloorToInt(gz);
+			float tx = gx - x0, ty = gy - y0, tz = gz - z0;
+
+			float values[8];
+			for (int i = 0; i < 8; ++i)
+			{
+				const Voxel* pVoxel = GetVoxel(x0 + (i & 1), y0 + ((i >> 1) & 1), z0 + ((i >> 2) & 1));
+				if (pVoxel == NULL || pVoxel->nWeight == 0)
+					return false;
+				values[i] = pVoxel->nTsdf / TSDF_SCALE;
+			}
+
+			float c00 = values[0] + (values[1] - values[0]) * tx;
+			float c10 = values[2] + (values[3] - values[2]) * tx;
+			float c01 = values[4] + (values[5] - values[4]) * tx;
+			float c11 = values[6] + (values[7] - values[6]) * tx;
+			float c0 = c00 + (c10 - c00) * ty;
+			float c1 = c01 + (c11 - c01) * ty;
+			fTsdf = c0 + (c1 - c0) * tz;
+			return true;
+		}
+
+		XnStatus TsdfVolume::Integrate(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes,
+			const DepthIntrinsics& intrinsics, const RigidTransform& cameraToWorld)
+		{
+			if (pDepth == NULL)
+				return XN_STATUS_NULL_INPUT_PTR;
+			if (nXRes == 0 || nYRes == 0)
+				return XN_STATUS_BAD_PARAM;
+
+			AllocateVisibleBlocks(pDepth, nXRes, nYRes, intrinsics, cameraToWorld);
+
+			RigidTransform worldToCamera = cameraToWorld.Inverse();
+			Concurrency::parallel_for(0, (int)m_visibleBlocks.size(), [&](int i)
+			{
+				IntegrateBlock(*m_blocks[m_visibleBlocks[i]], pDepth, nXRes, nYRes, intrinsics, worldToCamera);
+			});
+
+			return XN_STATUS_OK;
+		}
+
+		void TsdfVolume::AllocateVisibleBlocks(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes,
+			const DepthIntrinsics& intrinsics, const RigidTransform& cameraToWorld)
+		{
+			const float fBlockWorld = m_fVoxelSize * BLOCK_SIZE;
+			const float fInvBlock = 1.0f / fBlockWorld;
+			const float fStep = fBlockWorld * 0.5f;
+			const XnUInt32 nPixelStep = 2;
+
+			// collect the blocks covering the truncation band of every (subsampled) ray
+			Concurrency::combinable<std::vector<XnUInt64> > keys;
+			Concurrency::parallel_for(0, (int)((nYRes + nPixelStep - 1) / nPixelStep), [&](int nRow)
+			{
+				std::vector<XnUInt64>& local = keys.local();
+				XnUInt32 v = nRow * nPixelStep;
+				const XnUInt16* pRow = pDepth + v * nXRes;
+
+				XnUInt64 lastKey = 0;
+				for (XnUInt32 u = 0; u < nXRes; u += nPixelStep)
+				{
+					float d = pRow[u];
+					if (d == 0 || d < m_fMinRange || d > m_fMaxRange)
+						continue;
+
+					for (float s = d - m_fTruncation; s <= d + m_fTruncation; s += fStep)
+					{
+						Vector3f world = cameraToWorld.Apply(intrinsics.Unproject((float)u, (float)v, s));
+						XnUInt64 key = PackKey(FloorToInt(world.x * fInvBlock), FloorToInt(world.y * fInvBlock), FloorToInt(world.z * fInvBlock));
+						// neighbouring samples mostly hit the same block
+						if (key != lastKey)
+						{
+							local.push_back(key);
+							lastKey = key;
+						}
+					}
+				}
+			});
+
+			// hash insertion is serial, duplicates are filtered with the frame stamp
+			m_nFrameStamp++;
+			m_visibleBlocks.clear();
+			keys.combine_each([&](const std::vector<XnUInt64>& local)
+			{
+				for (size_t i = 0; i < local.size(); ++i)
+				{
+					XnInt32 x, y, z;
+					UnpackKey(local[i], x, y, z);
+
+					XnInt32 nIndex = FindOrAllocateBlock(x, y, z);
+					if (nIndex < 0)
+					{
+						m_nDroppedBlocks++;
+						continue;
+					}
+
+					Block* pBlock = m_blocks[nIndex];
+					if (pBlock->nVisibleStamp != m_nFrameStamp)
+					{
+						pBlock->nVisibleStamp = m_nFrameStamp;
+						m_visibleBlocks.push_back((XnUInt32)nIndex);
+					}
+				}
+			});
+		}
+
+		void TsdfVolume::IntegrateBlock(Block& block, const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes,
+			const DepthIntrinsics& intrinsics, const RigidTransform& worldToCamera)
+		{
+			const float* m = worldToCamera.m;
+			const float fInvTruncation = 1.0f / m_fTruncation;
+
+			// camera-space step for one voxel along x
+			const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+			const __m128 dx = _mm_set1_ps(m[0] * m_fVoxelSize);
+			const __m128 dy = _mm_set1_ps(m[4] * m_fVoxelSize);
+			const __m128 dz = _mm_set1_ps(m[8] * m_fVoxelSize);
+			const __m128 fx = _mm_set1_ps(intrinsics.fx);
+			const __m128 fy = _mm_set1_ps(intrinsics.fy);
+			const __m128 cx = _mm_set1_ps(intrinsics.cx + 0.5f);
+			const __m128 cy = _mm_set1_ps(intrinsics.cy + 0.5f);
+
+			float us[4];
+			float vs[4];
+			float zs[4];
+
+			bool bModified = false;
+			Voxel* pVoxel = block.voxels;
+
+			for (int lz = 0; lz < BLOCK_SIZE; ++lz)
+			{
+				for (int ly = 0; ly < BLOCK_SIZE; ++ly)
+				{
+					Vector3f rowStart = MakeVector3f(
+						(float)(block.x * BLOCK_SIZE) * m_fVoxelSize,
+						(float)(block.y * BLOCK_SIZE + ly) * m_fVoxelSize,
+						(float)(block.z * BLOCK_SIZE + lz) * m_fVoxelSize);
+					Vector3f camStart = worldToCamera.Apply(rowStart);
+
+					for (int lx = 0; lx < BLOCK_SIZE; lx += 4, pVoxel += 4)
+					{
+						// project four voxels at once
+						__m128 i = _mm_add_ps(lane, _mm_set1_ps((float)lx));
+						__m128 X = _mm_add_ps(_mm_set1_ps(camStart.x), _mm_mul_ps(i, dx));
+						__m128 Y = _mm_add_ps(_mm_set1_ps(camStart.y), _mm_mul_ps(i, dy));
+						__m128 Z = _mm_add_ps(_mm_set1_ps(camStart.z), _mm_mul_ps(i, dz));
+						__m128 invZ = _mm_div_ps(_mm_set1_ps(1.0f), Z);
+
+						_mm_storeu_ps(us, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(X, invZ), fx), cx));
+						_mm_storeu_ps(vs, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(Y, invZ), fy), cy));
+						_mm_storeu_ps(zs, Z);
+
+						for (int k = 0; k < 4; ++k)
+						{
+							if (zs[k] <= 0.0f || us[k] < 0.0f || vs[k] < 0.0f)
+								continue;
+
+							XnUInt32 u = (XnUInt32)us[k];
+							XnUInt32 v = (XnUInt32)vs[k];
+							if (u >= nXRes || v >= nYRes)
+								continue;
+
+							float d = pDepth[v * nXRes + u];
+							if (d == 0 || d < m_fMinRange || d > m_fMaxRange)
+								continue;
+
+							float sdf = d - zs[k];
+							if (sdf < -m_fTruncation)
+								continue;
+
+							float tsdf = sdf * fInvTruncation;
+							if (tsdf > 1.0f)
+								tsdf = 1.0f;
+
+							Voxel& voxel = pVoxel[k];
+							float w = voxel.nWeight;
+							float fused = (voxel.nTsdf / TSDF_SCALE * w + tsdf) / (w + 1.0f);
+
+							voxel.nTsdf = (XnInt16)(fused * TSDF_SCALE);
+							if (voxel.nWeight < MAX_WEIGHT)
+								voxel.nWeight++;
+							bModified = true;
+						}
+					}
+				}
+			}
+
+			if (bModified)
+				block.bModified = true;
+		}
+
+		void TsdfVolume::Raycast(const DepthIntrinsics& intrinsics, const RigidTransform& cameraToWorld,
+			XnUInt32 nXRes, XnUInt32 nYRes, XnUInt16* pDepth, float* pNormals) const
+		{
+			const float fBlockStep = m_fVoxelSize * BLOCK_SIZE * 0.5f;
+			const Vector3f origin = cameraToWorld.Translation();
+
+			Concurrency::parallel_for(0, (int)nYRes, [&](int v)
+			{
+				for (XnUInt32 u = 0; u < nXRes; ++u)
+				{
+					XnUInt32 nPixel = v * nXRes + u;
+					pDepth[nPixel] = 0;
+					if (pNormals != NULL)
+					{
+						pNormals[nPixel * 3] = pNormals[nPixel * 3 + 1] = pNormals[nPixel * 3 + 2] = 0.0f;
+					}
+
+					Vector3f dirCamera = Normalize(MakeVector3f((u - intrinsics.cx) / intrinsics.fx, (v - intrinsics.cy) / intrinsics.fy, 1.0f));
+					Vector3f dir = cameraToWorld.Rotate(dirCamera);
+
+					float t = m_fMinRange / dirCamera.z;
+					float tMax = m_fMaxRange / dirCamera.z;
+					float tPrev = t, fPrev = 0.0f;
+					bool bPrevValid = false;
+
+					while (t < tMax)
+					{
+						float f;
+						Vector3f sample = origin + dir * t;
+						if (!SampleTsdf(sample, f))
+						{
+							// skip unallocated blocks quickly, unobserved voxels voxel by voxel
+							bPrevValid = false;
+							t += IsBlockAllocated(sample) ? m_fVoxelSize : fBlockStep;
+							continue;
+						}
+
+						if (bPrevValid && fPrev >= 0.0f && f < 0.0f)
+						{
+							// zero crossing, refine with trilinear samples
+							float fa = fPrev, fb = f;
+							SampleTsdfTrilinear(origin + dir * tPrev, fa);
+							SampleTsdfTrilinear(origin + dir * t, fb);
+							float tHit = (fa >= 0.0f && fb < 0.0f) ? tPrev + (t - tPrev) * fa / (fa - fb) : tPrev;
+
+							float z = tHit * dirCamera.z;
+							pDepth[nPixel] = (XnUInt16)(z + 0.5f);
+
+							if (pNormals != NULL)
+							{
+								Vector3f hit = origin + dir * tHit;
+								float h = m_fVoxelSize;
+								float xp, xn, yp, yn, zp, zn;
+								if (SampleTsdfTrilinear(hit + MakeVector3f(h, 0, 0), xp) && SampleTsdfTrilinear(hit - MakeVector3f(h, 0, 0), xn) &&
+									SampleTsdfTrilinear(hit + MakeVector3f(0, h, 0), yp) && SampleTsdfTrilinear(hit - MakeVector3f(0, h, 0), yn) &&
+									SampleTsdfTrilinear(hit + MakeVector3f(0, 0, h), zp) && SampleTsdfTrilinear(hit - MakeVector3f(0, 0, h), zn))
+								{
+									// gradient in world space, rotated back into the camera frame
+									Vector3f n = Normalize(MakeVector3f(xp - xn, yp - yn, zp - zn));
+									const float* m = cameraToWorld.m;
+									pNormals[nPixel * 3]     = m[0] * n.x + m[4] * n.y + m[8] * n.z;
+									pNormals[nPixel * 3 + 1] = m[1] * n.x + m[5] * n.y + m[9] * n.z;
+									pNormals[nPixel * 3 + 2] = m[2] * n.x + m[6] * n.y + m[10] * n.z;
+								}
+							}
+							break;
+						}
+
+						bPrevValid = true;
+						fPrev = f;
+						tPrev = t;
+
+						// far from the surface the distance value allows larger steps
+						float step = (f > 0.0f) ? f * m_fTruncation * 0.8f : m_fVoxelSize;
+						t += (step > m_fVoxelSize) ? step : m_fVoxelSize;
+					}
+				}
+			});
+		}
+
+		const std::vector<float>& TsdfVolume::GetBlockTriangles(XnUInt32 nBlock) const
+		{
+			static const std::vector<float> noTriangles;
+			return nBlock < m_blockMeshes.size() ? m_blockMeshes[nBlock] : noTriangles;
+		}
+
+		XnUInt32 TsdfVolume::UpdateMesh()
+		{
+			m_blockMeshes.resize(m_blocks.size());
+			m_updatedBlocks.clear();
+
+			// cells at the lower border of a block read voxels of the block itself,
+			// so the negative neighbours of a modified block must be re-extracted too
+			std::vector<char> marked(m_blocks.size(), 0);
+			for (size_t i = 0; i < m_blocks.size(); ++i)
+			{
+				const Block* pBlock = m_blocks[i];
+				if (!pBlock->bModified)
+					continue;
+
+				for (int n = 0; n < 8; ++n)
+				{
+					XnInt32 nIndex = FindBlock(pBlock->x - (n & 1), pBlock->y - ((n >> 1) & 1), pBlock->z - ((n >> 2) & 1));
+					if (nIndex >= 0 && !marked[nIndex])
+					{
+						marked[nIndex] = 1;
+						m_updatedBlocks.push_back((XnUInt32)nIndex);
+					}
+				}
+			}
+
+			Concurrency::parallel_for(0, (int)m_updatedBlocks.size(), [&](int i)
+			{
+				ExtractBlock(m_updatedBlocks[i]);
+			});
+
+			for (size_t i = 0; i < m_blocks.size(); ++i)
+			{
+				m_blocks[i]->bModified = false;
+			}
+
+			return (XnUInt32)m_updatedBlocks.size();
+		}
+
+		void TsdfVolume::ExtractBlock(XnUInt32 nBlock)
+		{
+			// cube corners and its decomposition into six tetrahedra around the 0-6 diagonal
+			static const int s_corners[8][3] =
+			{
+				{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+				{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}
+			};
+			static const int s_tetrahedra[6][4] =
+			{
+				{0, 5, 1, 6}, {0, 1, 2, 6}, {0, 2, 3, 6},
+				{0, 3, 7, 6}, {0, 7, 4, 6}, {0, 4, 5, 6}
+			};
+
+			const Block& block = *m_blocks[nBlock];
+			std::vector<float>& out = m_blockMeshes[nBlock];
+			out.clear();
+
+			for (int lz = 0; lz < BLOCK_SIZE; ++lz)
+			{
+				for (int ly = 0; ly < BLOCK_SIZE; ++ly)
+				{
+					for (int lx = 0; lx < BLOCK_SIZE; ++lx)
+					{
+						bool bInterior = lx < BLOCK_SIZE - 1 && ly < BLOCK_SIZE - 1 && lz < BLOCK_SIZE - 1;
+						XnInt32 gx = block.x * BLOCK_SIZE + lx;
+						XnInt32 gy = block.y * BLOCK_SIZE + ly;
+						XnInt32 gz = block.z * BLOCK_SIZE + lz;
+
+						float f[8];
+						bool bValid = true;
+						bool bPositive = false, bNegative = false;
+						for (int c = 0; c < 8 && bValid; ++c)
+						{
+							const Voxel* pVoxel = bInterior
+								? &block.voxels[((lz + s_corners[c][2]) * BLOCK_SIZE + ly + s_corners[c][1]) * BLOCK_SIZE + lx + s_corners[c][0]]
+								: GetVoxel(gx + s_corners[c][0], gy + s_corners[c][1], gz + s_corners[c][2]);
+
+							if (pVoxel == NULL || pVoxel->nWeight == 0)
+							{
+								bValid = false;
+								break;
+							}
+
+							f[c] = pVoxel->nTsdf / TSDF_SCALE;
+							if (f[c] < 0.0f)
+								bNegative = true;
+							else
+								bPositive = true;
+						}
+
+						if (!bValid || !bPositive || !bNegative)
+							continue;
+
+						Vector3f p[8];
+						for (int c = 0; c < 8; ++c)
+						{
+							p[c] = MakeVector3f((gx + s_corners[c][0]) * m_fVoxelSize, (gy + s_corners[c][1]) * m_fVoxelSize, (gz + s_corners[c][2]) * m_fVoxelSize);
+						}
+
+						for (int t = 0; t < 6; ++t)
+						{
+							Vector3f tp[4];
+							float tf[4];
+							for (int k = 0; k < 4; ++k)
+							{
+								tp[k] = p[s_tetrahedra[t][k]];
+								tf[k] = f[s_tetrahedra[t][k]];
+							}
+							PolygonizeTetrahedron(tp, tf, out);
+						}
+					}
+				}
+			}
+		}
+
+		XnUInt32 TsdfVolume::GetTriangleCount() const
+		{
+			size_t nFloats = 0;
+			for (size_t i = 0; i < m_blockMeshes.size(); ++i)
+			{
+				nFloats += m_blockMeshes[i].size();
+			}
+			return (XnUInt32)(nFloats / 9);
+		}
+
+		void TsdfVolume::CopyTriangles(float* pVertices) const
+		{
+			for (size_t i = 0; i < m_blockMeshes.size(); ++i)
+			{
+				const std::vector<float>& mesh = m_blockMeshes[i];
+				if (mesh.empty())
+					continue;
+
+				memcpy(pVertices, &mesh[0], mesh.size() * sizeof(float));
+				pVertices += mesh.size();
+			}
+		}
+	}
+}
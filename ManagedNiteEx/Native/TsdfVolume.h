@@ -0,0 +1,105 @@
+#pragma once
+
+#include <XnOS.h>
+#include <vector>
+#include "Geometry.h"
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Truncated signed distance volume stored as a sparse hash of 8x8x8 voxel blocks.
+		// Blocks are allocated around observed surfaces only, up to a fixed budget.
+		class TsdfVolume
+		{
+		public:
+			static const int BLOCK_SIZE = 8;
+			static const int BLOCK_VOXELS = BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE;
+			static const XnUInt16 MAX_WEIGHT = 128;
+
+			struct Voxel
+			{
+				XnInt16 nTsdf;		// [-1, 1] scaled to [-32767, 32767]
+				XnUInt16 nWeight;
+			};
+
+			struct Block
+			{
+				XnInt32 x;
+				XnInt32 y;
+				XnInt32 z;
+				XnUInt32 nVisibleStamp;
+				bool bModified;
+				Voxel voxels[BLOCK_VOXELS];
+			};
+
+			TsdfVolume(float fVoxelSize, float fTruncation, XnUInt32 nMaxBlocks);
+			~TsdfVolume();
+
+			void Reset();
+
+			// Fuses a depth map (mm) taken from the given camera pose into the volume.
+			XnStatus Integrate(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes,
+				const DepthIntrinsics& intrinsics, const RigidTransform& cameraToWorld);
+
+			// Renders the fused surface from the given pose. pDepth receives camera z (mm, 0 = no hit),
+			// pNormals (optional) receives camera-space normals as xyz triples.
+			void Raycast(const DepthIntrinsics& intrinsics, const RigidTransform& cameraToWorld,
+				XnUInt32 nXRes, XnUInt32 nYRes, XnUInt16* pDepth, float* pNormals) const;
+
+			// Re-extracts the triangles of blocks modified since the last call.
+			// Returns the number of re-extracted blocks.
+			XnUInt32 UpdateMesh();
+
+			XnUInt32 GetTriangleCount() const;
+			// Writes all triangles as 9 floats (three xyz vertices, world mm) each.
+			void CopyTriangles(float* pVertices) const;
+
+			// Blocks re-extracted by the last UpdateMesh and their triangles. Blocks allocated
+			// after the last UpdateMesh have no triangles yet.
+			const std::vector<XnUInt32>& GetUpdatedBlocks() const { return m_updatedBlocks; }
+			const std::vector<float>& GetBlockTriangles(XnUInt32 nBlock) const;
+
+			float GetVoxelSize() const { return m_fVoxelSize; }
+			float GetTruncation() const { return m_fTruncation; }
+			XnUInt32 GetMaxBlocks() const { return m_nMaxBlocks; }
+			XnUInt32 GetBlockCount() const { return (XnUInt32)m_blocks.size(); }
+			XnUInt32 GetDroppedBlockCount() const { return m_nDroppedBlocks; }
+
+			float GetMinRange() const { return m_fMinRange; }
+			float GetMaxRange() const { return m_fMaxRange; }
+			void SetRange(float fMin, float fMax) { m_fMinRange = fMin; m_fMaxRange = fMax; }
+
+		private:
+			XnInt32 FindBlock(XnInt32 x, XnInt32 y, XnInt32 z) const;
+			XnInt32 FindOrAllocateBlock(XnInt32 x, XnInt32 y, XnInt32 z);
+			const Voxel* GetVoxel(XnInt32 x, XnInt32 y, XnInt32 z) const;
+			bool SampleTsdf(const Vector3f& world, float& fTsdf) const;
+			bool IsBlockAllocated(const Vector3f& world) const;
+			bool SampleTsdfTrilinear(const Vector3f& world, float& fTsdf) const;
+
+			void AllocateVisibleBlocks(const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes,
+				const DepthIntrinsics& intrinsics, const RigidTransform& cameraToWorld);
+			void IntegrateBlock(Block& block, const XnUInt16* pDepth, XnUInt32 nXRes, XnUInt32 nYRes,
+				const DepthIntrinsics& intrinsics, const RigidTransform& worldToCamera);
+			void ExtractBlock(XnUInt32 nBlock);
+
+			float m_fVoxelSize;
+			float m_fTruncation;
+			float m_fMinRange;
+			float m_fMaxRange;
+			XnUInt32 m_nMaxBlocks;
+			XnUInt32 m_nDroppedBlocks;
+			XnUInt32 m_nFrameStamp;
+
+			// open addressing table of block indices (-1 = empty), size is a power of two
+			std::vector<XnInt32> m_table;
+			XnUInt32 m_nTableMask;
+
+			std::vector<Block*> m_blocks;
+			std::vector<XnUInt32> m_visibleBlocks;
+			std::vector<std::vector<float> > m_blockMeshes;
+			std::vector<XnUInt32> m_updatedBlocks;
+		};
+	}
+}
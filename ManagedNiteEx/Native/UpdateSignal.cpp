@@ -0,0 +1,125 @@
+// Native (non /clr) translation unit - OpenNI invokes the callbacks on its own threads.
+
+#include "UpdateSignal.h"
+#include <windows.h>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		UpdateSignal::UpdateSignal()
+			: m_nPending(0), m_bAttached(false)
+		{
+			m_hAnyEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+			m_hAllEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		}
+
+		UpdateSignal::~UpdateSignal()
+		{
+			Detach();
+			CloseHandle(m_hAnyEvent);
+			CloseHandle(m_hAllEvent);
+		}
+
+		XnStatus UpdateSignal::Attach(xn::Context& context)
+		{
+			Detach();
+
+			xn::NodeInfoList list;
+			XnStatus status = context.EnumerateExistingNodes(list);
+			if (status != XN_STATUS_OK)
+				return status;
+
+			for (xn::NodeInfoList::Iterator it = list.Begin(); it != list.End(); ++it)
+			{
+				xn::NodeInfo info = *it;
+				if (!xnIsTypeGenerator(info.GetDescription().Type))
+					continue;
+
+				Entry* pEntry = new Entry();
+				pEntry->pOwner = this;
+				pEntry->bNewData = 0;
+
+				status = info.GetInstance(pEntry->generator);
+				if (status == XN_STATUS_OK)
+					status = pEntry->generator.RegisterToNewDataAvailable(OnNewDataAvailable, pEntry, pEntry->hCallback);
+
+				if (status != XN_STATUS_OK)
+				{
+					delete pEntry;
+					Detach();
+					return status;
+				}
+				m_entries.push_back(pEntry);
+			}
+
+			m_bAttached = true;
+			Rearm();
+			return XN_STATUS_OK;
+		}
+
+		void UpdateSignal::Detach()
+		{
+			for (size_t i = 0; i < m_entries.size(); ++i)
+			{
+				m_entries[i]->generator.UnregisterFromNewDataAvailable(m_entries[i]->hCallback);
+				delete m_entries[i];
+			}
+			m_entries.clear();
+			m_bAttached = false;
+		}
+
+		void UpdateSignal::Reset()
+		{
+			// events and count first: a notification raised after its flag was cleared must
+			// find its event in the state it sets. One raised before is dropped with its
+			// flag, the update or Rearm picks its data up.
+			ResetEvent(m_hAnyEvent);
+			ResetEvent(m_hAllEvent);
+			InterlockedExchange(&m_nPending, 0);
+			for (size_t i = 0; i < m_entries.size(); ++i)
+			{
+				InterlockedExchange(&m_entries[i]->bNewData, 0);
+			}
+		}
+
+		void UpdateSignal::Rearm()
+		{
+			// notifications raised during the update may refer to data it already consumed
+			Reset();
+
+			// data that arrived after its generator was updated
+			for (size_t i = 0; i < m_entries.size(); ++i)
+			{
+				if (m_entries[i]->generator.IsNewDataAvailable())
+					OnNewDataAvailable(m_entries[i]->generator, m_entries[i]);
+			}
+		}
+
+		XnStatus UpdateSignal::Wait(bool bAll, XnUInt32 nTimeoutMs)
+		{
+			if (m_entries.empty())
+				return XN_STATUS_OK;
+
+			DWORD result = WaitForSingleObject(bAll ? m_hAllEvent : m_hAnyEvent, nTimeoutMs);
+			if (result == WAIT_OBJECT_0)
+				return XN_STATUS_OK;
+			if (result == WAIT_TIMEOUT)
+				return XN_STATUS_WAIT_DATA_TIMEOUT;
+			return XN_STATUS_ERROR;
+		}
+
+		void XN_CALLBACK_TYPE UpdateSignal::OnNewDataAvailable(xn::ProductionNode& /*node*/, void* pCookie)
+		{
+			Entry* pEntry = (Entry*)pCookie;
+			UpdateSignal* pOwner = pEntry->pOwner;
+
+			if (InterlockedExchange(&pEntry->bNewData, 1) != 0)
+				return;
+
+			if (InterlockedIncrement(&pOwner->m_nPending) == (long)pOwner->m_entries.size())
+				SetEvent(pOwner->m_hAllEvent);
+			SetEvent(pOwner->m_hAnyEvent);
+		}
+	}
+}
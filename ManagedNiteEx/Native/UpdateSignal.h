@@ -0,0 +1,59 @@
+#pragma once
+
+#include <XnOS.h>
+#include <XnCppWrapper.h>
+#include <vector>
+
+namespace ManagedNiteEx
+{
+	namespace Native
+	{
+		// Listens to the new-data notifications of every generator in a context so callers 
+		// can wait (with a timeout) for any or all generators without polling OpenNI.
+		class UpdateSignal
+		{
+		public:
+			UpdateSignal();
+			~UpdateSignal();
+
+			// Registers to all existing generators of the context.
+			XnStatus Attach(xn::Context& context);
+			void Detach();
+
+			bool IsAttached() const { return m_bAttached; }
+			XnUInt32 GetGeneratorCount() const { return (XnUInt32)m_entries.size(); }
+
+			// Waits until any (or every) generator has new data. 
+			// Returns XN_STATUS_WAIT_DATA_TIMEOUT when the timeout (in ms) elapsed.
+			XnStatus Wait(bool bAll, XnUInt32 nTimeoutMs);
+
+			// Clears the pending flags. Call right before updating the context.
+			void Reset();
+
+			// Clears the flags again and re-raises them for generators that already have 
+			// newer data. Call right after the update so data consumed by it does not wake 
+			// the next wait while data arriving during the update is not lost.
+			void Rearm();
+
+			// Manual-reset event (HANDLE) signaled while any generator has pending data.
+			void* GetAnyDataEvent() const { return m_hAnyEvent; }
+
+		private:
+			struct Entry
+			{
+				UpdateSignal* pOwner;
+				xn::Generator generator;
+				XnCallbackHandle hCallback;
+				volatile long bNewData;
+			};
+
+			static void XN_CALLBACK_TYPE OnNewDataAvailable(xn::ProductionNode& node, void* pCookie);
+
+			std::vector<Entry*> m_entries;
+			void* m_hAnyEvent;
+			void* m_hAllEvent;
+			volatile long m_nPending;
+			bool m_bAttached;
+		};
+	}
+}
@@ -0,0 +1,81 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMCompositor.h"
+
+namespace ManagedNiteEx
+{
+	XnMCompositor::XnMCompositor()
+	{
+		this->m_pCompositor = new Native::Compositor();
+	}
+
+	XnMCompositor::~XnMCompositor()
+	{
+		delete m_pCompositor;
+		m_pCompositor = NULL;
+	}
+
+	void XnMCompositor::SetLabelColor(UInt16 label, Byte a, Byte r, Byte g, Byte b)
+	{
+		m_pCompositor->SetLabelColor(label, ((XnUInt32)a << 24) | ((XnUInt32)r << 16) | ((XnUInt32)g << 8) | b);
+	}
+
+	UInt32 XnMCompositor::GetLabelColor(UInt16 label)
+	{
+		return m_pCompositor->GetLabelColor(label);
+	}
+
+	void XnMCompositor::Compose(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta, XnMSceneMetaData^ sceneMeta,
+		IntPtr dest, Int32 width, Int32 height, Int32 stride)
+	{
+		if (width < 0 || height < 0 || stride < 0 || (Int64)stride < (Int64)width * 4)
+			XnMHelper::ThrowErrorException("Destination size must not be negative and stride must hold a BGRA32 row", XN_STATUS_BAD_PARAM);
+
+		Native::CompositorInput input;
+		memset(&input, 0, sizeof(input));
+
+		// every source must cover the same region of the field of view
+		XnMMapMetaData^ reference = nullptr;
+		array<XnMMapMetaData^>^ sources = { depthMeta, imageMeta, sceneMeta };
+		for each (XnMMapMetaData^ meta in sources)
+		{
+			if (meta == nullptr)
+				continue;
+
+			if (reference == nullptr)
+			{
+				reference = meta;
+			}
+			else if (meta->XRes != reference->XRes || meta->YRes != reference->YRes || 
+				meta->XOffset != reference->XOffset || meta->YOffset != reference->YOffset)
+			{
+				XnMHelper::ThrowErrorException("All composed maps must have the same resolution and crop", XN_STATUS_BAD_PARAM);
+			}
+		}
+
+		if (reference == nullptr)
+			return;
+
+		input.nXRes = reference->XRes;
+		input.nYRes = reference->YRes;
+		input.nXOffset = reference->XOffset;
+		input.nYOffset = reference->YOffset;
+
+		if (depthMeta != nullptr)
+			input.pDepth = (const XnUInt16*)depthMeta->MetaData->Data();
+		if (sceneMeta != nullptr)
+			input.pLabels = (const XnUInt16*)sceneMeta->MetaData->Data();
+		if (imageMeta != nullptr)
+		{
+			if (imageMeta->PixelFormat != XnMPixelFormat::Rgb24)
+				XnMHelper::ThrowErrorException("Only RGB24 images can be composed", XN_STATUS_BAD_PARAM);
+			input.pImage = (const XnUInt8*)imageMeta->MetaData->Data();
+		}
+
+		XnStatus status = m_pCompositor->Compose(input, (XnUInt8*)dest.ToPointer(), width, height, stride);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to compose frame", status);
+		}
+	}
+}
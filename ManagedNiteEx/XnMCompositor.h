@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "XnMDepthMetaData.h"
+#include "XnMImageMetaData.h"
+#include "XnMSceneMetaData.h"
+#include "Native/Compositor.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Blends depth, RGB and user labels of one frame set into a single BGRA32 
+	/// destination in one native pass.
+	/// </summary>
+	public ref class XnMCompositor
+	{
+	public:
+		XnMCompositor();
+
+		// Gets or sets the combination of layers to blend.
+		property XnMCompositeLayers Layers { 
+			XnMCompositeLayers get() { return (XnMCompositeLayers)m_pCompositor->GetLayers(); } 
+			void set(XnMCompositeLayers value) { m_pCompositor->SetLayers((XnUInt32)value); }
+		};
+
+		// Gets or sets the opacity of the depth layer when drawn over the RGB image.
+		property Byte DepthAlpha { 
+			Byte get() { return m_pCompositor->GetDepthAlpha(); } 
+			void set(Byte value) { m_pCompositor->SetDepthAlpha(value); }
+		};
+
+		// Gets or sets the intensity kept for background pixels by the highlight layer.
+		property Byte BackgroundLevel { 
+			Byte get() { return m_pCompositor->GetBackgroundLevel(); } 
+			void set(Byte value) { m_pCompositor->SetBackgroundLevel(value); }
+		};
+
+		// Sets the color used for a label. Alpha controls how the label is blended.
+		void SetLabelColor(UInt16 label, Byte a, Byte r, Byte g, Byte b);
+		UInt32 GetLabelColor(UInt16 label);
+
+		// Composes the frame set into a BGRA32 buffer of given size and stride (at least width * 4 bytes). 
+		// Metadata for layers that are not enabled may be null.
+		void Compose(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta, XnMSceneMetaData^ sceneMeta,
+			IntPtr dest, Int32 width, Int32 height, Int32 stride);
+
+	private:
+		~XnMCompositor();
+
+		Native::Compositor* m_pCompositor;
+	};
+}
@@ -0,0 +1,89 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMContourTracer.h"
+
+namespace ManagedNiteEx
+{
+	XnMContourTracer::XnMContourTracer()
+	{
+		this->m_pTracer = new Native::ContourTracer();
+	}
+
+	XnMContourTracer::~XnMContourTracer()
+	{
+		delete m_pTracer;
+		m_pTracer = NULL;
+	}
+
+	Int32 XnMContourTracer::Trace(XnMSceneMetaData^ sceneMeta)
+	{
+		xn::SceneMetaData* pScene = sceneMeta->MetaData;
+		return m_pTracer->Trace(pScene->Data(), NULL, pScene->XRes(), pScene->YRes());
+	}
+
+	Int32 XnMContourTracer::Trace(XnMSceneMetaData^ sceneMeta, XnMDepthMetaData^ depthMeta, XnMDepthGenerator^ depthGenerator)
+	{
+		xn::SceneMetaData* pScene = sceneMeta->MetaData;
+		xn::DepthMetaData* pDepth = depthMeta->MetaData;
+		if (pScene->XRes() != pDepth->XRes() || pScene->YRes() != pDepth->YRes() ||
+			pScene->XOffset() != pDepth->XOffset() || pScene->YOffset() != pDepth->YOffset())
+		{
+			XnMHelper::ThrowErrorException("Label and depth maps must have the same resolution and crop", XN_STATUS_BAD_PARAM);
+		}
+
+		XnUInt32 nContours = m_pTracer->Trace(pScene->Data(), pDepth->Data(), pScene->XRes(), pScene->YRes());
+
+		if (depthGenerator != nullptr)
+			nContours = m_pTracer->RemoveContoursWithoutDepth();
+
+		if (depthGenerator != nullptr && m_pTracer->GetPointCount() > 0)
+		{
+			XnPoint3D* pPoints = m_pTracer->GetPoints();
+
+			// conversion works in full frame coordinates
+			if (pScene->XOffset() != 0 || pScene->YOffset() != 0)
+			{
+				for (XnUInt32 i = 0; i < m_pTracer->GetPointCount(); ++i)
+				{
+					pPoints[i].X += pScene->XOffset();
+					pPoints[i].Y += pScene->YOffset();
+				}
+			}
+
+			xn::DepthGenerator* pGenerator = (xn::DepthGenerator*)depthGenerator->Node;
+			XnStatus status = pGenerator->ConvertProjectiveToRealWorld(m_pTracer->GetPointCount(), pPoints, pPoints);
+			if (status != XN_STATUS_OK)
+			{
+				XnMHelper::ThrowErrorException("Failed to convert contour points", status);
+			}
+		}
+
+		return nContours;
+	}
+
+	array<XnMContour>^ XnMContourTracer::GetContours()
+	{
+		array<XnMContour>^ result = gcnew array<XnMContour>(m_pTracer->GetContourCount());
+		const Native::Contour* pContours = m_pTracer->GetContours();
+		for (Int32 i = 0; i < result->Length; ++i)
+		{
+			result[i].Label = pContours[i].nLabel;
+			result[i].IsHole = pContours[i].bHole;
+			result[i].Area = pContours[i].nArea;
+			result[i].FirstPoint = pContours[i].nFirstPoint;
+			result[i].PointCount = pContours[i].nPointCount;
+		}
+		return result;
+	}
+
+	array<XnMPoint3D>^ XnMContourTracer::GetPoints()
+	{
+		array<XnMPoint3D>^ result = gcnew array<XnMPoint3D>(m_pTracer->GetPointCount());
+		if (result->Length > 0)
+		{
+			pin_ptr<XnMPoint3D> pResult = &result[0];
+			memcpy(pResult, m_pTracer->GetPoints(), result->Length * sizeof(XnPoint3D));
+		}
+		return result;
+	}
+}
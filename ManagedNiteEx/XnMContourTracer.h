@@ -0,0 +1,81 @@
+#pragma once
+
+#include "XnMPoint3D.h"
+#include "XnMSceneMetaData.h"
+#include "XnMDepthMetaData.h"
+#include "XnMDepthGenerator.h"
+#include "Native/ContourTracer.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Boundary polygon of one label. Its vertices are the PointCount points
+	/// starting at FirstPoint in the tracer's point array.
+	/// </summary>
+	public value struct XnMContour
+	{
+	public:
+		UInt16 Label;
+		// True for the boundary of an area of other labels enclosed by the label.
+		bool IsHole;
+		// Enclosed area in pixels (negative for holes).
+		Int32 Area;
+		Int32 FirstPoint;
+		Int32 PointCount;
+	};
+
+	/// <summary>
+	/// Extracts simplified outer and hole contours of every user label in one pass
+	/// over the label map.
+	/// </summary>
+	public ref class XnMContourTracer
+	{
+	public:
+		XnMContourTracer();
+
+		// Traces the label map. Points are in projective coordinates (pixel corners) with zero depth.
+		Int32 Trace(XnMSceneMetaData^ sceneMeta);
+
+		// Traces the label map and takes point depths from the depth map. Points without depth
+		// are interpolated from the neighbouring points of their contour. If depthGenerator
+		// is not null the points are converted to real world coordinates; contours without
+		// any depth are then left out, as they would collapse to the origin.
+		Int32 Trace(XnMSceneMetaData^ sceneMeta, XnMDepthMetaData^ depthMeta, XnMDepthGenerator^ depthGenerator);
+
+		array<XnMContour>^ GetContours();
+		array<XnMPoint3D>^ GetPoints();
+
+		// Gets or sets the maximal deviation (pixels) of the simplified polygons, 0 keeps every corner.
+		property Single Tolerance { 
+			Single get() { return m_pTracer->GetTolerance(); } 
+			void set(Single value) { m_pTracer->SetTolerance(value); }
+		};
+
+		// Gets or sets the smallest area (pixels) of reported contours.
+		property Int32 MinArea { 
+			Int32 get() { return m_pTracer->GetMinArea(); } 
+			void set(Int32 value) { m_pTracer->SetMinArea(value < 0 ? 0 : value); }
+		};
+
+		// Gets or sets whether hole contours are reported.
+		property bool IncludeHoles { 
+			bool get() { return m_pTracer->GetIncludeHoles(); } 
+			void set(bool value) { m_pTracer->SetIncludeHoles(value); }
+		};
+
+		// Gets the number of contours found by the last trace.
+		property Int32 ContourCount { 
+			Int32 get() { return m_pTracer->GetContourCount(); } 
+		};
+
+		// Gets the total number of points of the last trace.
+		property Int32 PointCount { 
+			Int32 get() { return m_pTracer->GetPointCount(); } 
+		};
+
+	private:
+		~XnMContourTracer();
+
+		Native::ContourTracer* m_pTracer;
+	};
+}
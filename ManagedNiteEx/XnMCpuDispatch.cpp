@@ -0,0 +1,25 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMCpuDispatch.h"
+
+namespace ManagedNiteEx
+{
+	void XnMCpuDispatch::Level::set(XnMCpuLevel value)
+	{
+		XnStatus status = Native::CpuDispatch::SetLevel((Native::CpuLevel)value);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("CPU level " + value.ToString() + " is not supported", status);
+		}
+	}
+
+	Int32 XnMCpuDispatch::GetMismatchCount(XnMCpuKernel kernel)
+	{
+		return (Int32)Native::CpuDispatch::GetMismatchCount((Native::CpuKernel)kernel);
+	}
+
+	void XnMCpuDispatch::ResetMismatches()
+	{
+		Native::CpuDispatch::ResetMismatches();
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "Native/CpuDispatch.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Controls which instruction set the native kernels use. The best level is selected 
+	/// when the library loads; the MANAGEDNITEEX_CPU_LEVEL and MANAGEDNITEEX_CPU_VERIFY 
+	/// environment variables override it before any code runs.
+	/// </summary>
+	public ref class XnMCpuDispatch abstract sealed
+	{
+	public:
+		// Gets the CPU features detected at load.
+		static property XnMCpuFeatures Features { 
+			XnMCpuFeatures get() { return (XnMCpuFeatures)Native::CpuDispatch::GetFeatures(); } 
+		};
+
+		// Gets the highest level supported by both the CPU and the build.
+		static property XnMCpuLevel SupportedLevel { 
+			XnMCpuLevel get() { return (XnMCpuLevel)Native::CpuDispatch::GetSupportedLevel(); } 
+		};
+
+		// Gets or sets the level in use. Levels above SupportedLevel are rejected.
+		static property XnMCpuLevel Level { 
+			XnMCpuLevel get() { return (XnMCpuLevel)Native::CpuDispatch::GetLevel(); } 
+			void set(XnMCpuLevel value);
+		};
+
+		// Gets or sets whether every kernel call is checked against the scalar reference.
+		static property bool Verify { 
+			bool get() { return Native::CpuDispatch::IsVerifying(); } 
+			void set(bool value) { Native::CpuDispatch::SetVerifying(value); }
+		};
+
+		// Gets the number of verified calls that differed from the scalar reference.
+		static property Int32 MismatchCount { 
+			Int32 get() { return (Int32)Native::CpuDispatch::GetTotalMismatchCount(); } 
+		};
+
+		static Int32 GetMismatchCount(XnMCpuKernel kernel);
+		static void ResetMismatches();
+	};
+}
@@ -1,4 +1,5 @@
 #include "StdAfx.h"
+#include "XnMHelper.h"
 #include "XnMDepthGenerator.h"
 
 namespace ManagedNiteEx 
@@ -18,5 +19,27 @@ namespace ManagedNiteEx
 	{
 		xn::DepthMetaData* nativeMeta = (xn::DepthMetaData*)depthMetaData->GetNativeObject();
 		m_pDepthGenerator->GetMetaData(*nativeMeta);
+		depthMetaData->UpdateHeader();
 	}
-}
\ No newline at end of file
+
+	void XnMDepthGenerator::GetMetaData(XnMDepthMetaData^ metaData, [Out] XnMFrameHeader% header)
+	{
+		GetMetaData(metaData);
+		header = metaData->Header;
+	}
+
+	Native::DepthIntrinsics XnMDepthGenerator::GetIntrinsics()
+	{
+		XnUInt64 zpd = GetIntProperty("ZPD");
+		XnDouble zpps = GetRealProperty("ZPPS");
+
+		XnMapOutputMode mode;
+		XnStatus status = m_pDepthGenerator->GetMapOutputMode(mode);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to get depth output mode", status);
+		}
+
+		return Native::DepthIntrinsics::FromZeroPlane(zpd, zpps, mode.nXRes, mode.nYRes);
+	}
+}
@@ -2,6 +2,7 @@
 
 #include "XnMMapGenerator.h"
 #include "XnMDepthMetaData.h"
+#include "Native/Geometry.h"
 
 namespace ManagedNiteEx 
 {
@@ -10,11 +11,16 @@ namespace ManagedNiteEx
 	{
 	internal:
 		XnMDepthGenerator(xn::DepthGenerator*);
+
+		// Pinhole model of the current output mode from the zero plane properties.
+		Native::DepthIntrinsics GetIntrinsics();
 	private:
 		~XnMDepthGenerator();
 
 	public:
 		void GetMetaData(XnMDepthMetaData^);
+		// Also returns the snapshot of the metadata (same as its Header property).
+		void GetMetaData(XnMDepthMetaData^ metaData, [Out] XnMFrameHeader% header);
 
 		//TODO:
 		//ConvertProjectiveToRealWorld 
@@ -0,0 +1,16 @@
+#include "StdAfx.h"
+#include "XnMDevice.h"
+
+namespace ManagedNiteEx
+{
+	XnMDevice::XnMDevice(xn::Device* pDevice)
+		: XnMProductionNode(pDevice)
+	{
+		this->m_pDevice = pDevice;
+	}
+
+	XnMDevice::~XnMDevice()
+	{
+		this->m_pDevice = NULL;
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "XnMProductionNode.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Represents a device node (the physical sensor)
+	/// </summary>
+	public ref class XnMDevice
+		: public XnMProductionNode
+	{
+	internal:
+		XnMDevice(xn::Device*);
+	private:
+		~XnMDevice();
+
+	protected:
+		xn::Device* m_pDevice;
+	};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Enumerations.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Blittable snapshot of map metadata, filled once per GetMetaData call so hot loops 
+	/// and unsafe code can read it without calling into the native metadata object
+	/// </summary>
+	[System::Runtime::InteropServices::StructLayout(System::Runtime::InteropServices::LayoutKind::Sequential)]
+	public value struct XnMFrameHeader
+	{
+	public:
+		// Number of columns and rows in the frame (after cropping)
+		UInt32 XRes;
+		UInt32 YRes;
+
+		// Offset of the buffer within the field of view
+		UInt32 XOffset;
+		UInt32 YOffset;
+
+		// Size of the entire field of view
+		UInt32 FullXRes;
+		UInt32 FullYRes;
+
+		XnMPixelFormat PixelFormat;
+		UInt32 BytesPerPixel;
+		UInt32 FPS;
+		UInt32 FrameID;
+
+		// Timestamp in microseconds as reported by the generator
+		UInt64 Timestamp;
+
+		// Buffer start, size in bytes and bytes per row
+		IntPtr Data;
+		UInt32 DataSize;
+		UInt32 Stride;
+	};
+}
@@ -0,0 +1,174 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMFrameSet.h"
+
+namespace ManagedNiteEx
+{
+	XnMFrameSet::XnMFrameSet(Native::FrameProducts* pFrame)
+	{
+		this->m_pFrame = pFrame;
+	}
+
+	XnMFrameSet::~XnMFrameSet()
+	{
+		this->!XnMFrameSet();
+	}
+
+	XnMFrameSet::!XnMFrameSet()
+	{
+		if (m_pFrame != NULL)
+		{
+			m_pFrame->Release();
+			m_pFrame = NULL;
+		}
+	}
+
+	Native::FrameProducts* XnMFrameSet::GetFrame()
+	{
+		if (m_pFrame == NULL)
+			throw gcnew ObjectDisposedException("XnMFrameSet");
+		return m_pFrame;
+	}
+
+	XnMFrameSet^ XnMFrameSet::Share()
+	{
+		Native::FrameProducts* pFrame = GetFrame();
+		pFrame->AddRef();
+		return gcnew XnMFrameSet(pFrame);
+	}
+
+	bool XnMFrameSet::IsComputed(XnMFrameProduct product)
+	{
+		if (product < XnMFrameProduct::Histogram || product > XnMFrameProduct::LabelStats)
+			return false;
+		bool bComputed = GetFrame()->IsComputed((Native::FrameProducts::Product)product);
+		// the finalizer must not return the frame to the pool while the native call runs
+		GC::KeepAlive(this);
+		return bComputed;
+	}
+
+	IntPtr XnMFrameSet::GetHistogram()
+	{
+		IntPtr result((void*)GetFrame()->GetHistogram());
+		GC::KeepAlive(this);
+		return result;
+	}
+
+	void XnMFrameSet::CopyHistogram(array<Int32>^ histogram)
+	{
+		if (histogram == nullptr || histogram->Length < MaxDepth)
+			XnMHelper::ThrowErrorException("Histogram array must hold MaxDepth values", XN_STATUS_BAD_PARAM);
+
+		const XnUInt32* pHistogram = GetFrame()->GetHistogram();
+		if (pHistogram == NULL)
+		{
+			Array::Clear(histogram, 0, MaxDepth);
+		}
+		else
+		{
+			pin_ptr<Int32> pDest = &histogram[0];
+			memcpy(pDest, pHistogram, MaxDepth * sizeof(XnUInt32));
+		}
+		GC::KeepAlive(this);
+	}
+
+	IntPtr XnMFrameSet::GetPoints()
+	{
+		IntPtr result((void*)GetFrame()->GetPoints());
+		GC::KeepAlive(this);
+		return result;
+	}
+
+	IntPtr XnMFrameSet::GetNormals()
+	{
+		IntPtr result((void*)GetFrame()->GetNormals());
+		GC::KeepAlive(this);
+		return result;
+	}
+
+	IntPtr XnMFrameSet::GetBgra()
+	{
+		IntPtr result((void*)GetFrame()->GetBgra());
+		GC::KeepAlive(this);
+		return result;
+	}
+
+	array<XnMLabelStats>^ XnMFrameSet::GetLabelStats()
+	{
+		const std::vector<Native::FrameProducts::LabelStats>& stats = GetFrame()->GetLabelStats();
+
+		array<XnMLabelStats>^ result = gcnew array<XnMLabelStats>((int)stats.size());
+		for (int i = 0; i < result->Length; ++i)
+		{
+			const Native::FrameProducts::LabelStats& s = stats[i];
+			result[i].Label = s.nLabel;
+			result[i].PixelCount = s.nPixels;
+			result[i].MinX = s.nMinX;
+			result[i].MinY = s.nMinY;
+			result[i].MaxX = s.nMaxX;
+			result[i].MaxY = s.nMaxY;
+			result[i].CenterX = s.fCenterX;
+			result[i].CenterY = s.fCenterY;
+			result[i].MeanDepth = s.fMeanDepth;
+			result[i].Center = XnMPoint3D(s.center.x, s.center.y, s.center.z);
+		}
+		GC::KeepAlive(this);
+		return result;
+	}
+
+	Int32 XnMFrameSet::HistogramPoints::get()
+	{
+		Int32 nPoints = (Int32)GetFrame()->GetHistogramPoints();
+		GC::KeepAlive(this);
+		return nPoints;
+	}
+
+	UInt32 XnMFrameSet::FrameID::get()
+	{
+		UInt32 nFrameID = GetFrame()->GetFrameID();
+		GC::KeepAlive(this);
+		return nFrameID;
+	}
+
+	UInt64 XnMFrameSet::Timestamp::get()
+	{
+		UInt64 nTimestamp = GetFrame()->GetTimestamp();
+		GC::KeepAlive(this);
+		return nTimestamp;
+	}
+
+	Int32 XnMFrameSet::XRes::get()
+	{
+		Int32 nXRes = GetFrame()->GetXRes();
+		GC::KeepAlive(this);
+		return nXRes;
+	}
+
+	Int32 XnMFrameSet::YRes::get()
+	{
+		Int32 nYRes = GetFrame()->GetYRes();
+		GC::KeepAlive(this);
+		return nYRes;
+	}
+
+	bool XnMFrameSet::HasDepth::get()
+	{
+		bool bHas = GetFrame()->HasDepth();
+		GC::KeepAlive(this);
+		return bHas;
+	}
+
+	bool XnMFrameSet::HasImage::get()
+	{
+		bool bHas = GetFrame()->HasImage();
+		GC::KeepAlive(this);
+		return bHas;
+	}
+
+	bool XnMFrameSet::HasLabels::get()
+	{
+		bool bHas = GetFrame()->HasLabels();
+		GC::KeepAlive(this);
+		return bHas;
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "XnMPoint3D.h"
+#include "Native/FrameProducts.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Pixel count, bounds and center of mass of one user label
+	/// </summary>
+	public value struct XnMLabelStats
+	{
+	public:
+		UInt16 Label;
+		Int32 PixelCount;
+		Int32 MinX;
+		Int32 MinY;
+		Int32 MaxX;
+		Int32 MaxY;
+		// Projective center of mass.
+		Single CenterX;
+		Single CenterY;
+		// Mean depth (mm) of the label pixels with depth, 0 without any.
+		Single MeanDepth;
+		// Real world center of mass, zero without depth.
+		XnMPoint3D Center;
+	};
+
+	/// <summary>
+	/// One frame set acquired from an XnMFrameSetPool. Its derived products are computed
+	/// on first request, at most once per frame however many consumers ask, and are freed
+	/// back to the pool when every reference to the frame set has been disposed.
+	/// </summary>
+	public ref class XnMFrameSet
+	{
+	public:
+		// Number of bins of the depth histogram (depths from 0 to MaxDepth - 1 mm).
+		static const Int32 MaxDepth = Native::FrameProducts::MAX_DEPTH;
+
+		// Returns another reference to the same frame set for a consumer that disposes it separately.
+		XnMFrameSet^ Share();
+
+		bool IsComputed(XnMFrameProduct product);
+
+		// Product pointers point into the pooled frame, not into managed memory: they stay
+		// valid only until the last reference (this one and every Share) is disposed or
+		// finalized, so keep a reference alive while using them. They are IntPtr.Zero when
+		// the frame set lacks the source map.
+
+		// MaxDepth UInt32 counts.
+		IntPtr GetHistogram();
+		// Copies the histogram into a reusable array of at least MaxDepth elements.
+		void CopyHistogram(array<Int32>^ histogram);
+		// XRes * YRes real world xyz float triples (mm), zero for pixels without depth.
+		IntPtr GetPoints();
+		// XRes * YRes unit normal xyz float triples facing the camera, zero where undefined.
+		IntPtr GetNormals();
+		// XRes * YRes BGRA32 pixels.
+		IntPtr GetBgra();
+		array<XnMLabelStats>^ GetLabelStats();
+
+		// Gets the number of pixels counted by the histogram.
+		property Int32 HistogramPoints { Int32 get(); };
+
+		property UInt32 FrameID { UInt32 get(); };
+		property UInt64 Timestamp { UInt64 get(); };
+		property Int32 XRes { Int32 get(); };
+		property Int32 YRes { Int32 get(); };
+		property bool HasDepth { bool get(); };
+		property bool HasImage { bool get(); };
+		property bool HasLabels { bool get(); };
+
+	internal:
+		// Takes over one reference of the native frame.
+		XnMFrameSet(Native::FrameProducts* pFrame);
+
+	private:
+		~XnMFrameSet();
+		// returns the frame to the pool when a consumer forgot to dispose it
+		!XnMFrameSet();
+
+		Native::FrameProducts* GetFrame();
+
+		Native::FrameProducts* m_pFrame;
+	};
+}
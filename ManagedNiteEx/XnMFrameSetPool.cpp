@@ -0,0 +1,96 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMFrameSetPool.h"
+
+namespace ManagedNiteEx
+{
+	XnMFrameSetPool::XnMFrameSetPool()
+	{
+		this->m_pPool = new Native::FrameProductsPool(4);
+		this->m_pIntrinsics = new Native::DepthIntrinsics(Native::DepthIntrinsics::Create(575.8f, 320.0f, 240.0f));
+	}
+
+	XnMFrameSetPool::XnMFrameSetPool(Int32 maxFree)
+	{
+		this->m_pPool = new Native::FrameProductsPool(maxFree < 0 ? 0 : maxFree);
+		this->m_pIntrinsics = new Native::DepthIntrinsics(Native::DepthIntrinsics::Create(575.8f, 320.0f, 240.0f));
+	}
+
+	XnMFrameSetPool::~XnMFrameSetPool()
+	{
+		// frame sets still alive keep the native pool until they are disposed
+		m_pPool->Release();
+		m_pPool = NULL;
+		delete m_pIntrinsics;
+		m_pIntrinsics = NULL;
+	}
+
+	void XnMFrameSetPool::SetIntrinsics(Single focalLength, Single centerX, Single centerY)
+	{
+		*m_pIntrinsics = Native::DepthIntrinsics::Create(focalLength, centerX, centerY);
+	}
+
+	void XnMFrameSetPool::SetIntrinsics(XnMDepthGenerator^ generator)
+	{
+		*m_pIntrinsics = generator->GetIntrinsics();
+	}
+
+	void XnMFrameSetPool::CheckResolution(xn::MapMetaData* pMeta, XnUInt32& nXRes, XnUInt32& nYRes)
+	{
+		if (nXRes == 0 && nYRes == 0)
+		{
+			nXRes = pMeta->XRes();
+			nYRes = pMeta->YRes();
+		}
+		else if (pMeta->XRes() != nXRes || pMeta->YRes() != nYRes)
+		{
+			XnMHelper::ThrowErrorException("All maps of a frame set must have the same resolution", XN_STATUS_BAD_PARAM);
+		}
+	}
+
+	XnMFrameSet^ XnMFrameSetPool::Acquire(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta, XnMSceneMetaData^ sceneMeta)
+	{
+		Native::FrameSource source;
+		memset(&source, 0, sizeof(source));
+		source.intrinsics = *m_pIntrinsics;
+
+		xn::OutputMetaData* pFirst = NULL;
+
+		if (depthMeta != nullptr)
+		{
+			xn::DepthMetaData* pDepth = depthMeta->MetaData;
+			CheckResolution(pDepth, source.nXRes, source.nYRes);
+			source.pDepth = pDepth->Data();
+			pFirst = pDepth;
+		}
+
+		if (imageMeta != nullptr)
+		{
+			if (imageMeta->PixelFormat != XnMPixelFormat::Rgb24)
+				XnMHelper::ThrowErrorException("Only RGB24 images are supported", XN_STATUS_BAD_PARAM);
+
+			xn::ImageMetaData* pImage = imageMeta->MetaData;
+			CheckResolution(pImage, source.nXRes, source.nYRes);
+			source.pImage = pImage->Data();
+			if (pFirst == NULL)
+				pFirst = pImage;
+		}
+
+		if (sceneMeta != nullptr)
+		{
+			xn::SceneMetaData* pScene = sceneMeta->MetaData;
+			CheckResolution(pScene, source.nXRes, source.nYRes);
+			source.pLabels = pScene->Data();
+			if (pFirst == NULL)
+				pFirst = pScene;
+		}
+
+		if (pFirst != NULL)
+		{
+			source.nFrameID = pFirst->FrameID();
+			source.nTimestamp = pFirst->Timestamp();
+		}
+
+		return gcnew XnMFrameSet(m_pPool->Acquire(source));
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "XnMFrameSet.h"
+#include "XnMDepthGenerator.h"
+#include "XnMDepthMetaData.h"
+#include "XnMImageMetaData.h"
+#include "XnMSceneMetaData.h"
+#include "Native/FrameProducts.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Creates frame sets from the current maps of a context and recycles the buffers 
+	/// of retired frame sets, so renderers and analytics modules share one set of 
+	/// derived products per frame without allocating.
+	/// </summary>
+	public ref class XnMFrameSetPool
+	{
+	public:
+		XnMFrameSetPool();
+		// Keeps at most maxFree retired frame sets for reuse.
+		XnMFrameSetPool(Int32 maxFree);
+
+		// Intrinsics used for the real world points of the following frame sets.
+		void SetIntrinsics(Single focalLength, Single centerX, Single centerY);
+		// Uses the zero plane distance and pixel size (ZPD, ZPPS) of the depth generator.
+		void SetIntrinsics(XnMDepthGenerator^ generator);
+
+		// Copies the maps into a frame set. Any map may be null, the others must share
+		// the resolution and the image must be RGB24. Dispose the frame set when done.
+		XnMFrameSet^ Acquire(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta, XnMSceneMetaData^ sceneMeta);
+
+		property Int32 MaxFree { 
+			Int32 get() { return m_pPool->GetMaxFree(); } 
+		};
+
+		// Gets the number of retired frame sets waiting for reuse.
+		property Int32 FreeCount { 
+			Int32 get() { return m_pPool->GetFreeCount(); } 
+		};
+
+		// Gets the number of frame sets not yet disposed.
+		property Int32 LiveCount { 
+			Int32 get() { return m_pPool->GetLiveCount(); } 
+		};
+
+	private:
+		~XnMFrameSetPool();
+
+		static void CheckResolution(xn::MapMetaData* pMeta, XnUInt32& nXRes, XnUInt32& nYRes);
+
+		Native::FrameProductsPool* m_pPool;
+		Native::DepthIntrinsics* m_pIntrinsics;
+	};
+}
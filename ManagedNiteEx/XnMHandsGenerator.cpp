@@ -0,0 +1,91 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMHandsGenerator.h"
+
+namespace ManagedNiteEx 
+{
+	XnMHandsGenerator::XnMHandsGenerator(xn::HandsGenerator* pHandsGenerator)
+		: XnMGenerator(pHandsGenerator)
+	{
+		this->m_pHandsGenerator = pHandsGenerator;
+		this->m_pTracker = new Native::HandTracker(*pHandsGenerator, MaxHands);
+
+		XnStatus status = m_pTracker->Attach();
+		if (status != XN_STATUS_OK)
+		{
+			// the destructor does not run for a constructor that throws
+			delete m_pTracker;
+			m_pTracker = NULL;
+			XnMHelper::ThrowErrorException("Failed to register hand callbacks", status);
+		}
+
+		this->m_filter = gcnew XnMJointFilter(&m_pTracker->GetFilter());
+	}
+
+	XnMHandsGenerator::~XnMHandsGenerator()
+	{
+		Detach();
+		this->m_pHandsGenerator = NULL;
+	}
+
+	void XnMHandsGenerator::Detach()
+	{
+		delete m_pTracker;
+		m_pTracker = NULL;
+		if (m_filter != nullptr)
+			m_filter->Detach();
+	}
+
+	Native::HandTracker* XnMHandsGenerator::GetTracker()
+	{
+		if (m_pTracker == NULL)
+			throw gcnew ObjectDisposedException("XnMHandsGenerator");
+		return m_pTracker;
+	}
+
+	void XnMHandsGenerator::StartTracking(XnMPoint3D position)
+	{
+		XnPoint3D point = { position.X, position.Y, position.Z };
+		XnStatus status = m_pHandsGenerator->StartTracking(point);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to start hand tracking", status);
+		}
+	}
+
+	void XnMHandsGenerator::StopTracking(UInt32 id)
+	{
+		XnStatus status = m_pHandsGenerator->StopTracking(id);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to stop hand tracking", status);
+		}
+	}
+
+	void XnMHandsGenerator::StopTrackingAll()
+	{
+		XnStatus status = m_pHandsGenerator->StopTrackingAll();
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to stop hand tracking", status);
+		}
+	}
+
+	void XnMHandsGenerator::SetSmoothing(Single factor)
+	{
+		XnStatus status = m_pHandsGenerator->SetSmoothing(factor);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to set hand smoothing", status);
+		}
+	}
+
+	Int32 XnMHandsGenerator::GetHands(array<XnMHandPoint>^ hands)
+	{
+		if (hands == nullptr || hands->Length == 0)
+			return 0;
+
+		pin_ptr<XnMHandPoint> pHands = &hands[0];
+		return GetTracker()->GetHands((Native::HandPoint*)pHands, hands->Length);
+	}
+}
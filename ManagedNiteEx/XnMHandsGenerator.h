@@ -0,0 +1,61 @@
+#pragma once
+
+#include "XnMGenerator.h"
+#include "XnMPoint3D.h"
+#include "XnMJointFilter.h"
+#include "Native/HandTracker.h"
+
+namespace ManagedNiteEx 
+{
+	/// <summary>
+	/// Tracked hand point, layout compatible with the native record
+	/// </summary>
+	public value struct XnMHandPoint
+	{
+	public:
+		UInt32 Id;
+		Single X;
+		Single Y;
+		Single Z;
+		// Time of the last update in seconds.
+		Single Time;
+	};
+
+	public ref class XnMHandsGenerator
+		: public XnMGenerator
+	{
+	internal:
+		XnMHandsGenerator(xn::HandsGenerator*);
+		virtual void Detach() override;
+	private:
+		~XnMHandsGenerator();
+
+	public:
+		// Maximal number of simultaneously reported hands
+		static const Int32 MaxHands = 8;
+
+		void StartTracking(XnMPoint3D position);
+		void StopTracking(UInt32 id);
+		void StopTrackingAll();
+
+		// Sets the smoothing factor of the hands generator itself (0 = none).
+		void SetSmoothing(Single factor);
+
+		// Copies the currently tracked hands into the array. Returns their number.
+		Int32 GetHands(array<XnMHandPoint>^ hands);
+
+		// Gets the filter applied to hand points.
+		property XnMJointFilter^ Filter { 
+			XnMJointFilter^ get() { return m_filter; } 
+		};
+
+	protected:
+		xn::HandsGenerator* m_pHandsGenerator;
+
+	private:
+		Native::HandTracker* GetTracker();
+
+		Native::HandTracker* m_pTracker;
+		XnMJointFilter^ m_filter;
+	};
+}
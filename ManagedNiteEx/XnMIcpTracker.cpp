@@ -0,0 +1,121 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMIcpTracker.h"
+
+namespace ManagedNiteEx
+{
+	XnMIcpTracker::XnMIcpTracker()
+	{
+		this->m_pTracker = new Native::IcpTracker(3);
+		this->m_pModelDepth = new std::vector<XnUInt16>();
+		this->m_pModelNormals = new std::vector<float>();
+	}
+
+	XnMIcpTracker::XnMIcpTracker(Int32 levels)
+	{
+		if (levels <= 0 || levels > (Int32)Native::IcpTracker::MAX_LEVELS)
+			XnMHelper::ThrowErrorException("Invalid number of pyramid levels", XN_STATUS_BAD_PARAM);
+
+		this->m_pTracker = new Native::IcpTracker(levels);
+		this->m_pModelDepth = new std::vector<XnUInt16>();
+		this->m_pModelNormals = new std::vector<float>();
+	}
+
+	XnMIcpTracker::~XnMIcpTracker()
+	{
+		delete m_pTracker;
+		m_pTracker = NULL;
+		delete m_pModelDepth;
+		m_pModelDepth = NULL;
+		delete m_pModelNormals;
+		m_pModelNormals = NULL;
+	}
+
+	array<Single>^ XnMIcpTracker::ToArray(const Native::RigidTransform& transform)
+	{
+		array<Single>^ result = gcnew array<Single>(16);
+		pin_ptr<Single> pResult = &result[0];
+		transform.ToMatrix4x4(pResult);
+		return result;
+	}
+
+	void XnMIcpTracker::SetIntrinsics(Single focalLength, Single centerX, Single centerY)
+	{
+		m_pTracker->SetIntrinsics(Native::DepthIntrinsics::Create(focalLength, centerX, centerY));
+	}
+
+	void XnMIcpTracker::SetIntrinsics(XnMDepthGenerator^ generator)
+	{
+		m_pTracker->SetIntrinsics(generator->GetIntrinsics());
+	}
+
+	XnMIcpResult XnMIcpTracker::Track(XnMDepthMetaData^ depthMeta)
+	{
+		return TrackFrame(depthMeta, true);
+	}
+
+	XnMIcpResult XnMIcpTracker::Track(XnMDepthMetaData^ depthMeta, XnMTsdfVolume^ model)
+	{
+		xn::DepthMetaData* pMeta = depthMeta->MetaData;
+		XnUInt32 nPixels = pMeta->XRes() * pMeta->YRes();
+		m_pModelDepth->resize(nPixels);
+		m_pModelNormals->resize(nPixels * 3);
+
+		// render the model as seen from the last tracked pose
+		model->Volume->Raycast(m_pTracker->GetIntrinsics(), m_pTracker->GetPose(), 
+			pMeta->XRes(), pMeta->YRes(), &(*m_pModelDepth)[0], &(*m_pModelNormals)[0]);
+		m_pTracker->SetReference(&(*m_pModelDepth)[0], &(*m_pModelNormals)[0], pMeta->XRes(), pMeta->YRes());
+
+		return TrackFrame(depthMeta, false);
+	}
+
+	XnMIcpResult XnMIcpTracker::TrackFrame(XnMDepthMetaData^ depthMeta, bool updateReference)
+	{
+		xn::DepthMetaData* pMeta = depthMeta->MetaData;
+
+		Native::IcpResult native;
+		XnStatus status = m_pTracker->Track(pMeta->Data(), pMeta->XRes(), pMeta->YRes(), updateReference, native);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to track depth frame", status);
+		}
+
+		XnMIcpResult result;
+		result.Pose = ToArray(native.pose);
+		result.Delta = ToArray(native.delta);
+		result.Residual = native.fResidual;
+		result.Inliers = native.nInliers;
+		result.ValidPoints = native.nValidPoints;
+		result.Iterations = native.nIterations;
+		result.Converged = native.bConverged;
+		return result;
+	}
+
+	void XnMIcpTracker::Reset()
+	{
+		m_pTracker->Reset();
+	}
+
+	array<Single>^ XnMIcpTracker::Pose::get()
+	{
+		return ToArray(m_pTracker->GetPose());
+	}
+
+	void XnMIcpTracker::Pose::set(array<Single>^ value)
+	{
+		m_pTracker->SetPose(XnMTsdfVolume::ToRigidTransform(value));
+	}
+
+	Int32 XnMIcpTracker::GetIterations(Int32 level)
+	{
+		return m_pTracker->GetIterations(level);
+	}
+
+	void XnMIcpTracker::SetIterations(Int32 level, Int32 iterations)
+	{
+		if (level < 0 || level >= (Int32)m_pTracker->GetLevels() || iterations < 0)
+			XnMHelper::ThrowErrorException("Invalid iteration setting", XN_STATUS_BAD_PARAM);
+
+		m_pTracker->SetIterations(level, iterations);
+	}
+}
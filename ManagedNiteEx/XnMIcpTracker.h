@@ -0,0 +1,93 @@
+#pragma once
+
+#include "XnMDepthGenerator.h"
+#include "XnMDepthMetaData.h"
+#include "XnMTsdfVolume.h"
+#include "Native/IcpTracker.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Outcome of aligning one depth frame
+	/// </summary>
+	public value struct XnMIcpResult
+	{
+	public:
+		// Camera-to-world pose after the frame (row-major 4x4).
+		array<Single>^ Pose;
+		// Motion of the camera relative to the reference frame (row-major 4x4).
+		array<Single>^ Delta;
+		// RMS point-to-plane distance of the inliers in millimeters.
+		Single Residual;
+		Int32 Inliers;
+		Int32 ValidPoints;
+		Int32 Iterations;
+		bool Converged;
+	};
+
+	/// <summary>
+	/// Tracks the camera pose with coarse-to-fine projective point-to-plane ICP, either
+	/// frame-to-frame or against a raycast of a fused volume.
+	/// </summary>
+	public ref class XnMIcpTracker
+	{
+	public:
+		XnMIcpTracker();
+		XnMIcpTracker(Int32 levels);
+
+		void SetIntrinsics(Single focalLength, Single centerX, Single centerY);
+		void SetIntrinsics(XnMDepthGenerator^ generator);
+
+		// Aligns the frame to the last one that converged. The first frame only becomes the reference.
+		XnMIcpResult Track(XnMDepthMetaData^ depthMeta);
+
+		// Aligns the frame to the surface of the volume rendered from the current pose.
+		XnMIcpResult Track(XnMDepthMetaData^ depthMeta, XnMTsdfVolume^ model);
+
+		// Forgets the reference and resets the pose to identity.
+		void Reset();
+
+		// Gets or sets the camera-to-world pose (row-major 4x4).
+		property array<Single>^ Pose { 
+			array<Single>^ get();
+			void set(array<Single>^ value);
+		};
+
+		// Gets the number of pyramid levels.
+		property Int32 Levels { 
+			Int32 get() { return m_pTracker->GetLevels(); } 
+		};
+
+		// Gets or sets the maximal distance (mm) between associated points.
+		property Single DistanceThreshold { 
+			Single get() { return m_pTracker->GetDistanceThreshold(); } 
+			void set(Single value) { m_pTracker->SetDistanceThreshold(value); }
+		};
+
+		// Gets or sets the maximal angle (radians) between associated normals.
+		property Single AngleThreshold { 
+			Single get() { return m_pTracker->GetAngleThreshold(); } 
+			void set(Single value) { m_pTracker->SetAngleThreshold(value); }
+		};
+
+		// Gets or sets the share of valid points that must be associated for a frame to be tracked.
+		property Single MinInlierRatio { 
+			Single get() { return m_pTracker->GetMinInlierRatio(); } 
+			void set(Single value) { m_pTracker->SetMinInlierRatio(value); }
+		};
+
+		// Gets or sets the maximal number of iterations on a pyramid level (0 = finest).
+		Int32 GetIterations(Int32 level);
+		void SetIterations(Int32 level, Int32 iterations);
+
+	private:
+		~XnMIcpTracker();
+
+		XnMIcpResult TrackFrame(XnMDepthMetaData^ depthMeta, bool updateReference);
+		static array<Single>^ ToArray(const Native::RigidTransform& transform);
+
+		Native::IcpTracker* m_pTracker;
+		std::vector<XnUInt16>* m_pModelDepth;
+		std::vector<float>* m_pModelNormals;
+	};
+}
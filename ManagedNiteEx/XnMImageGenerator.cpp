@@ -24,5 +24,12 @@ namespace ManagedNiteEx
 	{
 		xn::ImageMetaData* nativeMeta = (xn::ImageMetaData*)imageMeta->GetNativeObject();
 		m_pImageGenerator->GetMetaData(*nativeMeta);
+		imageMeta->UpdateHeader();
+	}
+
+	void XnMImageGenerator::GetMetaData(XnMImageMetaData^ metaData, [Out] XnMFrameHeader% header)
+	{
+		GetMetaData(metaData);
+		header = metaData->Header;
 	}
 }
\ No newline at end of file
@@ -26,6 +26,8 @@ namespace ManagedNiteEx
 		//GetRGB24ImageMap 
 		//GetYUV422ImageMap 
 		void GetMetaData(XnMImageMetaData^);
+		// Also returns the snapshot of the metadata (same as its Header property).
+		void GetMetaData(XnMImageMetaData^ metaData, [Out] XnMFrameHeader% header);
 
 		XnMPixelFormat GetPixelFormat();
 		//IsPixelFormatSupported 
@@ -0,0 +1,63 @@
+#include "StdAfx.h"
+#include "XnMJointFilter.h"
+
+namespace ManagedNiteEx
+{
+	XnMJointFilter::XnMJointFilter(Native::JointFilter* pFilter)
+	{
+		this->m_pFilter = pFilter;
+	}
+
+	Native::JointFilter* XnMJointFilter::GetFilter()
+	{
+		if (m_pFilter == NULL)
+			throw gcnew ObjectDisposedException("XnMJointFilter");
+		return m_pFilter;
+	}
+
+	// the tracker filters on the threads that update the context, so changes take the filter lock
+
+	void XnMJointFilter::Mode::set(XnMJointFilterMode value)
+	{
+		Native::JointFilter* pFilter = GetFilter();
+		Native::JointFilter::ScopedLock guard(*pFilter);
+		pFilter->SetMode((Native::JointFilter::Mode)value);
+	}
+
+	void XnMJointFilter::MinConfidence::set(Single value)
+	{
+		Native::JointFilter* pFilter = GetFilter();
+		Native::JointFilter::ScopedLock guard(*pFilter);
+		pFilter->SetMinConfidence(value);
+	}
+
+	void XnMJointFilter::MaxHoldFrames::set(Int32 value)
+	{
+		Native::JointFilter* pFilter = GetFilter();
+		Native::JointFilter::ScopedLock guard(*pFilter);
+		pFilter->SetMaxHoldFrames(value < 0 ? 0 : value);
+	}
+
+	void XnMJointFilter::SetDoubleExponential(Single smoothing, Single correction, Single prediction, Single jitterRadius, Single maxDeviationRadius)
+	{
+		Native::DoubleExponentialParams params = { smoothing, correction, prediction, jitterRadius, maxDeviationRadius };
+		Native::JointFilter* pFilter = GetFilter();
+		Native::JointFilter::ScopedLock guard(*pFilter);
+		pFilter->SetDoubleExponentialParams(params);
+	}
+
+	void XnMJointFilter::SetOneEuro(Single minCutoff, Single beta, Single derivativeCutoff)
+	{
+		Native::OneEuroParams params = { minCutoff, beta, derivativeCutoff };
+		Native::JointFilter* pFilter = GetFilter();
+		Native::JointFilter::ScopedLock guard(*pFilter);
+		pFilter->SetOneEuroParams(params);
+	}
+
+	void XnMJointFilter::Reset()
+	{
+		Native::JointFilter* pFilter = GetFilter();
+		Native::JointFilter::ScopedLock guard(*pFilter);
+		pFilter->Reset();
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "Native/JointFilter.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Settings of the native temporal filter applied by a user or hands generator
+	/// </summary>
+	public ref class XnMJointFilter
+	{
+	internal:
+		XnMJointFilter(Native::JointFilter* pFilter);
+
+		// Called when the owning generator releases its tracker, later use throws.
+		void Detach() { m_pFilter = NULL; }
+
+	public:
+		// Gets or sets the filter. Changing it drops the filter history.
+		property XnMJointFilterMode Mode { 
+			XnMJointFilterMode get() { return (XnMJointFilterMode)GetFilter()->GetMode(); } 
+			void set(XnMJointFilterMode value);
+		};
+
+		// Gets or sets the confidence below which a joint does not update the filter.
+		property Single MinConfidence { 
+			Single get() { return GetFilter()->GetMinConfidence(); } 
+			void set(Single value);
+		};
+
+		// Gets or sets how many frames the last position is held for a low-confidence joint.
+		property Int32 MaxHoldFrames { 
+			Int32 get() { return GetFilter()->GetMaxHoldFrames(); } 
+			void set(Int32 value);
+		};
+
+		// Sets the double exponential parameters. Radii are in millimeters.
+		void SetDoubleExponential(Single smoothing, Single correction, Single prediction, Single jitterRadius, Single maxDeviationRadius);
+
+		// Sets the one euro parameters. Cutoffs are in Hz, beta per mm/s.
+		void SetOneEuro(Single minCutoff, Single beta, Single derivativeCutoff);
+
+		// Drops the history of all joints.
+		void Reset();
+
+	private:
+		Native::JointFilter* GetFilter();
+
+		Native::JointFilter* m_pFilter;
+	};
+}
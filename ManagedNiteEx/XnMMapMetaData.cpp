@@ -8,4 +8,25 @@ namespace ManagedNiteEx
 	{
 		m_pMapMeta = pMeta;
 	}
+
+	void XnMMapMetaData::UpdateHeader()
+	{
+		const xn::MapMetaData* pMeta = m_pMapMeta;
+		XnMFrameHeader header;
+		header.XRes = pMeta->XRes();
+		header.YRes = pMeta->YRes();
+		header.XOffset = pMeta->XOffset();
+		header.YOffset = pMeta->YOffset();
+		header.FullXRes = pMeta->FullXRes();
+		header.FullYRes = pMeta->FullYRes();
+		header.PixelFormat = (XnMPixelFormat)pMeta->PixelFormat();
+		header.BytesPerPixel = pMeta->BytesPerPixel();
+		header.FPS = pMeta->FPS();
+		header.FrameID = pMeta->FrameID();
+		header.Timestamp = pMeta->Timestamp();
+		header.Data = IntPtr((void*)pMeta->Data());
+		header.DataSize = pMeta->DataSize();
+		header.Stride = header.XRes * header.BytesPerPixel;
+		m_header = header;
+	}
 }
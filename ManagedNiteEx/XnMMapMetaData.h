@@ -1,6 +1,7 @@
 #pragma once
 
 #include "XnMOutputMetaData.h"
+#include "XnMFrameHeader.h"
 #include "Enumerations.h"
 
 namespace ManagedNiteEx
@@ -19,6 +20,9 @@ namespace ManagedNiteEx
 			xn::MapMetaData* get() { return m_pMapMeta; }
 		}
 
+		// Takes a new snapshot of the native metadata into Header.
+		void UpdateHeader();
+
 	public:
 
 		// Gets the number of bytes each pixel occupies. 
@@ -65,6 +69,11 @@ namespace ManagedNiteEx
 			XnMPixelFormat get() { return (XnMPixelFormat)MetaData->PixelFormat(); } 
 		};
 
+		// Gets the snapshot taken by the last GetMetaData. Reading it does not call native code.
+		property XnMFrameHeader Header { 
+			XnMFrameHeader get() { return m_header; } 
+		};
+
 		// AllocateData()
 		// ReAdjust()
 	private:
@@ -73,5 +82,6 @@ namespace ManagedNiteEx
 		}
 
 		xn::MapMetaData* m_pMapMeta;
+		XnMFrameHeader m_header;
 	};
 }
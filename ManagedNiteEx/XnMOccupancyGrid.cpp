@@ -0,0 +1,45 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMOccupancyGrid.h"
+
+namespace ManagedNiteEx
+{
+	XnMOccupancyGrid::XnMOccupancyGrid(Single originX, Single originZ, Single cellSize, Int32 cellsX, Int32 cellsZ, Int32 layers)
+	{
+		if (cellSize <= 0 || cellsX <= 0 || cellsZ <= 0 || layers <= 0)
+			XnMHelper::ThrowErrorException("Invalid grid parameters", XN_STATUS_BAD_PARAM);
+
+		this->m_pGrid = new Native::OccupancyGrid(originX, originZ, cellSize, cellsX, cellsZ, layers);
+	}
+
+	XnMOccupancyGrid::~XnMOccupancyGrid()
+	{
+		delete m_pGrid;
+		m_pGrid = NULL;
+	}
+
+	void XnMOccupancyGrid::Clear()
+	{
+		m_pGrid->Clear();
+	}
+
+	void XnMOccupancyGrid::CheckCopy(Int32 layer, array<Int32>^ values)
+	{
+		if (layer < 0 || layer >= (Int32)m_pGrid->GetLayers())
+			XnMHelper::ThrowErrorException("Invalid grid layer", XN_STATUS_BAD_PARAM);
+		if (values == nullptr || values->Length < (Int32)m_pGrid->GetCellCount())
+			XnMHelper::ThrowErrorException("Array is smaller than the grid", XN_STATUS_BAD_PARAM);
+	}
+
+	void XnMOccupancyGrid::CopyCounts(Int32 layer, array<Int32>^ counts)
+	{
+		CheckCopy(layer, counts);
+		Marshal::Copy(IntPtr((void*)m_pGrid->GetCounts(layer)), counts, 0, m_pGrid->GetCellCount());
+	}
+
+	void XnMOccupancyGrid::CopyHeights(Int32 layer, array<Int32>^ heights)
+	{
+		CheckCopy(layer, heights);
+		Marshal::Copy(IntPtr((void*)m_pGrid->GetHeights(layer)), heights, 0, m_pGrid->GetCellCount());
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Native/OccupancyGrid.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Top-down grid of point counts and maximal heights over the floor. Several 
+	/// projectors (one per sensor) may project into the same grid concurrently.
+	/// </summary>
+	public ref class XnMOccupancyGrid
+	{
+	public:
+		// Height reported for cells without points
+		static const Int32 NoHeight = Native::OccupancyGrid::NO_HEIGHT;
+
+		// Creates a grid of cellsX by cellsZ cells of cellSize (mm) starting at the floor 
+		// coordinates originX, originZ. With more than one layer points are split by user label.
+		XnMOccupancyGrid(Single originX, Single originZ, Single cellSize, Int32 cellsX, Int32 cellsZ, Int32 layers);
+
+		// Resets all cells.
+		void Clear();
+
+		// Copies the counts or heights (mm) of a layer, z rows of x cells, into a reusable array.
+		void CopyCounts(Int32 layer, array<Int32>^ counts);
+		void CopyHeights(Int32 layer, array<Int32>^ heights);
+
+		property Single OriginX { 
+			Single get() { return m_pGrid->GetOriginX(); } 
+		};
+
+		property Single OriginZ { 
+			Single get() { return m_pGrid->GetOriginZ(); } 
+		};
+
+		property Single CellSize { 
+			Single get() { return m_pGrid->GetCellSize(); } 
+		};
+
+		property Int32 CellsX { 
+			Int32 get() { return m_pGrid->GetCellsX(); } 
+		};
+
+		property Int32 CellsZ { 
+			Int32 get() { return m_pGrid->GetCellsZ(); } 
+		};
+
+		property Int32 Layers { 
+			Int32 get() { return m_pGrid->GetLayers(); } 
+		};
+
+	internal:
+		property Native::OccupancyGrid* Grid { 
+			Native::OccupancyGrid* get() { return m_pGrid; }
+		}
+
+	private:
+		~XnMOccupancyGrid();
+
+		void CheckCopy(Int32 layer, array<Int32>^ values);
+
+		Native::OccupancyGrid* m_pGrid;
+	};
+}
@@ -0,0 +1,57 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMTsdfVolume.h"
+#include "XnMOccupancyProjector.h"
+
+namespace ManagedNiteEx
+{
+	XnMOccupancyProjector::XnMOccupancyProjector()
+	{
+		this->m_pProjector = new Native::OccupancyProjector();
+	}
+
+	XnMOccupancyProjector::~XnMOccupancyProjector()
+	{
+		delete m_pProjector;
+		m_pProjector = NULL;
+	}
+
+	void XnMOccupancyProjector::SetIntrinsics(Single focalLength, Single centerX, Single centerY)
+	{
+		m_pProjector->SetIntrinsics(Native::DepthIntrinsics::Create(focalLength, centerX, centerY));
+	}
+
+	void XnMOccupancyProjector::SetIntrinsics(XnMDepthGenerator^ generator)
+	{
+		m_pProjector->SetIntrinsics(generator->GetIntrinsics());
+	}
+
+	void XnMOccupancyProjector::SetPose(array<Single>^ sensorToFloor)
+	{
+		m_pProjector->SetSensorToFloor(XnMTsdfVolume::ToRigidTransform(sensorToFloor));
+	}
+
+	void XnMOccupancyProjector::SetFloorPlane(XnMPoint3D point, XnMPoint3D normal)
+	{
+		if (normal.X == 0 && normal.Y == 0 && normal.Z == 0)
+			XnMHelper::ThrowErrorException("Invalid floor normal", XN_STATUS_BAD_PARAM);
+
+		m_pProjector->SetFloorPlane(Native::MakeVector3f(point.X, point.Y, point.Z), 
+			Native::MakeVector3f(normal.X, normal.Y, normal.Z));
+	}
+
+	Int32 XnMOccupancyProjector::Project(XnMDepthMetaData^ depthMeta, XnMSceneMetaData^ sceneMeta, XnMOccupancyGrid^ grid)
+	{
+		xn::DepthMetaData* pDepth = depthMeta->MetaData;
+		const XnUInt16* pLabels = NULL;
+		if (sceneMeta != nullptr)
+		{
+			xn::SceneMetaData* pScene = sceneMeta->MetaData;
+			if (pScene->XRes() != pDepth->XRes() || pScene->YRes() != pDepth->YRes())
+				XnMHelper::ThrowErrorException("Label and depth maps must have the same resolution", XN_STATUS_BAD_PARAM);
+			pLabels = pScene->Data();
+		}
+
+		return m_pProjector->Project(pDepth->Data(), pLabels, pDepth->XRes(), pDepth->YRes(), *grid->Grid);
+	}
+}
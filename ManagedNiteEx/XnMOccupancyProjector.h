@@ -0,0 +1,60 @@
+#pragma once
+
+#include "XnMPoint3D.h"
+#include "XnMDepthGenerator.h"
+#include "XnMDepthMetaData.h"
+#include "XnMSceneMetaData.h"
+#include "XnMOccupancyGrid.h"
+#include "Native/OccupancyGrid.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Projects the depth frames of one sensor into an XnMOccupancyGrid, using all cores.
+	/// Each core fills a private copy of the grid (8 bytes per cell and layer) that the
+	/// projector keeps between frames, so large grids cost that much memory per core.
+	/// </summary>
+	public ref class XnMOccupancyProjector
+	{
+	public:
+		XnMOccupancyProjector();
+
+		void SetIntrinsics(Single focalLength, Single centerX, Single centerY);
+		void SetIntrinsics(XnMDepthGenerator^ generator);
+
+		// Places the sensor by a row-major 4x4 transform from depth camera space 
+		// (x right, y down, z forward) to the floor frame (Y up).
+		void SetPose(array<Single>^ sensorToFloor);
+
+		// Places the sensor by the floor plane in real world coordinates, e.g. from XnMSceneAnalyzer.GetFloor.
+		void SetFloorPlane(XnMPoint3D point, XnMPoint3D normal);
+
+		// Projects the frame into the grid. sceneMeta may be null; otherwise points are split by label
+		// and points of labels beyond the grid's last layer are skipped.
+		// Returns the number of points counted.
+		Int32 Project(XnMDepthMetaData^ depthMeta, XnMSceneMetaData^ sceneMeta, XnMOccupancyGrid^ grid);
+
+		// Gets or sets the lowest height (mm above the floor) counted.
+		property Single MinHeight { 
+			Single get() { return m_pProjector->GetMinHeight(); } 
+			void set(Single value) { m_pProjector->SetHeightBand(value, m_pProjector->GetMaxHeight()); }
+		};
+
+		// Gets or sets the highest height (mm above the floor) counted.
+		property Single MaxHeight { 
+			Single get() { return m_pProjector->GetMaxHeight(); } 
+			void set(Single value) { m_pProjector->SetHeightBand(m_pProjector->GetMinHeight(), value); }
+		};
+
+		// Gets or sets the pixel subsampling step.
+		property Int32 PixelStep { 
+			Int32 get() { return m_pProjector->GetPixelStep(); } 
+			void set(Int32 value) { m_pProjector->SetPixelStep(value < 1 ? 1 : value); }
+		};
+
+	private:
+		~XnMOccupancyProjector();
+
+		Native::OccupancyProjector* m_pProjector;
+	};
+}
@@ -1,16 +1,86 @@
 #include "StdAfx.h"
 #include "XnMHelper.h"
+#include "XnMException.h"
 #include "XnMOpenNIContextEx.h"
 
+using namespace System::Collections::Generic;
+using namespace System::Threading;
+using namespace System::Threading::Tasks;
+
 namespace ManagedNiteEx
 {
+	// Exposes the native new-data event to the thread pool wait infrastructure.
+	ref class XnMNativeWaitHandle : public WaitHandle
+	{
+	public:
+		XnMNativeWaitHandle(IntPtr handle)
+		{
+			this->SafeWaitHandle = gcnew Microsoft::Win32::SafeHandles::SafeWaitHandle(handle, false);
+		}
+	};
+
+	// Gives each caller of WaitForFrameAsync its own cancelable view of the shared frame task.
+	ref class XnMCancelableFrame
+	{
+	public:
+		static Task<UInt32>^ Create(Task<UInt32>^ frameTask, CancellationToken token)
+		{
+			XnMCancelableFrame^ frame = gcnew XnMCancelableFrame();
+			frame->m_source = gcnew TaskCompletionSource<UInt32>();
+			frame->m_registration = token.Register(gcnew Action(frame, &XnMCancelableFrame::OnCanceled));
+			frameTask->ContinueWith(gcnew Action<Task<UInt32>^>(frame, &XnMCancelableFrame::OnCompleted), 
+				TaskContinuationOptions::ExecuteSynchronously);
+			return frame->m_source->Task;
+		}
+
+	private:
+		void OnCanceled()
+		{
+			m_source->TrySetCanceled();
+		}
+
+		void OnCompleted(Task<UInt32>^ frameTask)
+		{
+			m_registration.Dispose();
+			if (frameTask->IsFaulted)
+				m_source->TrySetException(frameTask->Exception->InnerExceptions);
+			else if (frameTask->IsCanceled)
+				m_source->TrySetCanceled();
+			else
+				m_source->TrySetResult(frameTask->Result);
+		}
+
+		TaskCompletionSource<UInt32>^ m_source;
+		CancellationTokenRegistration m_registration;
+	};
+
 	XnMOpenNIContextEx::XnMOpenNIContextEx(void)
 	{
 		this->m_pniContext = new xn::Context();
+		this->m_pUpdateSignal = NULL;
+		this->m_updateLock = gcnew Object();
+		this->m_nFrameNumber = 0;
+		this->m_pPublisher = NULL;
+
+		this->m_pNodes = new std::vector<xn::ProductionNode*>();
+		this->m_nodesByType = gcnew Dictionary<Int32, XnMProductionNode^>();
+		this->m_nodesByName = gcnew Dictionary<String^, XnMProductionNode^>();
+		this->m_nodeList = gcnew List<XnMProductionNode^>();
+		this->m_nodeWrappers = gcnew List<XnMProductionNode^>();
 	}
 
 	XnMOpenNIContextEx::~XnMOpenNIContextEx()
 	{
+		CancelPendingFrame();
+		delete m_pUpdateSignal;
+		m_pUpdateSignal = NULL;
+
+		delete m_pPublisher;
+		m_pPublisher = NULL;
+
+		ClearNodeRegistry();
+		delete m_pNodes;
+
 		this->m_pniContext->Shutdown();
 		delete m_pniContext;
 	}
@@ -18,6 +88,8 @@ namespace ManagedNiteEx
 	UInt32 XnMOpenNIContextEx::InitFromXmlFile(System::String^ xmlFileName) 
 	{
 		XnStatus status;
+		XnMStartupTimings^ timings = gcnew XnMStartupTimings();
+		System::Diagnostics::Stopwatch^ watch = System::Diagnostics::Stopwatch::StartNew();
 		
 		//TODO: add error enumeration
 		EnumerationErrors errors;
@@ -35,45 +107,512 @@ namespace ManagedNiteEx
 			XnMHelper::ThrowErrorException("Failed to open XML config", status);
 			return status;
 		}
+		timings->m_xmlInit = watch->Elapsed;
 
-		xn::NodeInfoList list = xn::NodeInfoList();
+		// enumerate and wrap every node once, lookups are served from the registry
+		watch->Restart();
+		std::vector<xn::Generator> generators;
+		status = BuildNodeRegistry(generators);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to enumerate production nodes", status);
+		}
+		timings->m_nodeRegistry = watch->Elapsed;
 
 		// Make sure all generators are generating data. 
-		status = m_pniContext->StartGeneratingAll();
-		if (status == XN_STATUS_OK) {
-			//return 
+		watch->Restart();
+		std::vector<Native::GeneratorStartResult> results;
+		status = Native::StartGeneratorsParallel(generators, results);
+		timings->m_generatorStart = watch->Elapsed;
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			TimeSpan duration = TimeSpan::FromTicks((Int64)results[i].nDurationUs * 10);
+			if (duration > timings->m_slowestGenerator)
+				timings->m_slowestGenerator = duration;
+		}
+
+		m_startupTimings = timings;
+
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to start generators", status);
+		}
+		return status;
+	}
+
+	XnStatus XnMOpenNIContextEx::BuildNodeRegistry(std::vector<xn::Generator>& generators)
+	{
+		// Wrappers handed out before hold a reference to their node, so a node of the same
+		// instance name is still that node: its wrapper is reused instead of wrapped again.
+		Dictionary<String^, XnMProductionNode^>^ previous = m_nodesByName;
+		m_nodesByName = gcnew Dictionary<String^, XnMProductionNode^>();
+		m_nodesByType->Clear();
+		m_nodeList->Clear();
+
+		xn::NodeInfoList list;
+		XnStatus status = m_pniContext->EnumerateExistingNodes(list);
+		if (status != XN_STATUS_OK)
+			return status;
+
+		for (xn::NodeInfoList::Iterator it = list.Begin(); it != list.End(); ++it)
+		{
+			xn::NodeInfo info = *it;
+			XnProductionNodeType type = info.GetDescription().Type;
+
+			XnMProductionNode^ node;
+			if (previous->TryGetValue(XnMHelper::CreateString(info.GetInstanceName()), node))
+			{
+				AddNodeLookup(node, type);
+			}
+			else
+			{
+				xn::ProductionNode* pNode = CreateNativeNode(type);
+				status = info.GetInstance(*pNode);
+				if (status != XN_STATUS_OK)
+				{
+					delete pNode;
+					return status;
+				}
+
+				RegisterNode(pNode, type);
+			}
+
+			if (xnIsTypeGenerator(type))
+			{
+				xn::Generator generator;
+				status = info.GetInstance(generator);
+				if (status == XN_STATUS_OK)
+					generators.push_back(generator);
+			}
+		}
+		return XN_STATUS_OK;
+	}
+
+	XnMProductionNode^ XnMOpenNIContextEx::RegisterNode(xn::ProductionNode* pNode, XnProductionNodeType type)
+	{
+		m_pNodes->push_back(pNode);
+
+		XnMProductionNode^ node = WrapProductionNode(pNode);
+		m_nodeWrappers->Add(node);
+		AddNodeLookup(node, type);
+		return node;
+	}
+
+	void XnMOpenNIContextEx::AddNodeLookup(XnMProductionNode^ node, XnProductionNodeType type)
+	{
+		m_nodeList->Add(node);
+
+		// the first node of each type answers FindExistingNode(type), like OpenNI does
+		if (!m_nodesByType->ContainsKey((Int32)type))
+			m_nodesByType->Add((Int32)type, node);
+
+		m_nodesByName[XnMHelper::CreateString(node->Node->GetName())] = node;
+	}
+
+	void XnMOpenNIContextEx::ClearNodeLookup()
+	{
+		m_nodesByType->Clear();
+		m_nodesByName->Clear();
+		m_nodeList->Clear();
+	}
+
+	void XnMOpenNIContextEx::ClearNodeRegistry()
+	{
+		ClearNodeLookup();
+
+		// trackers of user and hands wrappers unregister their callbacks while the nodes still exist
+		for each (XnMProductionNode^ node in m_nodeWrappers)
+		{
+			node->Detach();
 		}
+		m_nodeWrappers->Clear();
+
+		for (size_t i = 0; i < m_pNodes->size(); i++)
+		{
+			delete (*m_pNodes)[i];
+		}
+		m_pNodes->clear();
 	}
 
 	UInt32 XnMOpenNIContextEx::Shutdown() {
+		CancelPendingFrame();
+		if (m_pUpdateSignal != NULL)
+			m_pUpdateSignal->Detach();
+
+		StopPublishing();
+		ClearNodeRegistry();
+
 		this->m_pniContext->Shutdown();
 		return 0;
 	}
 
+	static XnStatus WaitAndUpdate(xn::Context& context, xn::ProductionNode* /*pNode*/)
+	{
+		return context.WaitAndUpdateAll();
+	}
+
+	static XnStatus WaitAnyUpdate(xn::Context& context, xn::ProductionNode* /*pNode*/)
+	{
+		return context.WaitAnyUpdateAll();
+	}
+
+	static XnStatus WaitOneUpdate(xn::Context& context, xn::ProductionNode* pNode)
+	{
+		return context.WaitOneUpdateAll(*pNode);
+	}
+
+	static XnStatus WaitNoneUpdate(xn::Context& context, xn::ProductionNode* /*pNode*/)
+	{
+		return context.WaitNoneUpdateAll();
+	}
+
 	UInt32 XnMOpenNIContextEx::WaitAndUpdateAll()
 	{
-	    XnStatus status = 0;
-		status = this->m_pniContext->WaitAndUpdateAll();
+		return BlockingUpdate(WaitAndUpdate, NULL);
+	}
+
+	UInt32 XnMOpenNIContextEx::WaitAnyUpdateAll()
+	{
+		return BlockingUpdate(WaitAnyUpdate, NULL);
+	}
+
+	UInt32 XnMOpenNIContextEx::WaitOneUpdateAll(XnMProductionNode^ node)
+	{
+		return BlockingUpdate(WaitOneUpdate, node->Node);
+	}
+
+	UInt32 XnMOpenNIContextEx::WaitNoneUpdateAll()
+	{
+		return BlockingUpdate(WaitNoneUpdate, NULL);
+	}
+
+	XnStatus XnMOpenNIContextEx::BlockingUpdate(XnStatus (*pUpdate)(xn::Context&, xn::ProductionNode*), xn::ProductionNode* pNode)
+	{
+		XnStatus status;
+
+		// the same sequence as the signaled updates, so their events do not refer to data consumed here
+		Monitor::Enter(m_updateLock);
+		try
+		{
+			bool bSignal = m_pUpdateSignal != NULL && m_pUpdateSignal->IsAttached();
+			if (bSignal)
+				m_pUpdateSignal->Reset();
+			status = pUpdate(*m_pniContext, pNode);
+			if (bSignal)
+				m_pUpdateSignal->Rearm();
+			m_nFrameNumber++;
+		}
+		finally
+		{
+			Monitor::Exit(m_updateLock);
+		}
+
 		if (status != XN_STATUS_OK)
 		{
 			XnMHelper::ThrowErrorException("Update failed", status);
 		}
+		PublishFrame();
 		return status;
 	}
 
+	bool XnMOpenNIContextEx::WaitAndUpdateAll(Int32 timeoutMilliseconds)
+	{
+		return WaitSignalAndUpdate(true, timeoutMilliseconds);
+	}
+
+	bool XnMOpenNIContextEx::WaitAnyUpdateAll(Int32 timeoutMilliseconds)
+	{
+		return WaitSignalAndUpdate(false, timeoutMilliseconds);
+	}
+
+	Task<UInt32>^ XnMOpenNIContextEx::WaitForFrameAsync()
+	{
+		return WaitForFrameAsync(CancellationToken::None);
+	}
+
+	Task<UInt32>^ XnMOpenNIContextEx::WaitForFrameAsync(CancellationToken cancellationToken)
+	{
+		EnsureUpdateSignal();
+
+		TaskCompletionSource<UInt32>^ frame;
+		Monitor::Enter(m_updateLock);
+		try
+		{
+			// the first caller registers the native wait, later callers share it
+			if (m_pendingFrame == nullptr)
+			{
+				m_pendingFrame = gcnew TaskCompletionSource<UInt32>();
+				m_pendingWait = ThreadPool::RegisterWaitForSingleObject(m_anyDataHandle, 
+					gcnew WaitOrTimerCallback(this, &XnMOpenNIContextEx::OnFrameSignaled), 
+					nullptr, Timeout::Infinite, true);
+			}
+			frame = m_pendingFrame;
+		}
+		finally
+		{
+			Monitor::Exit(m_updateLock);
+		}
+
+		if (!cancellationToken.CanBeCanceled)
+			return frame->Task;
+
+		return XnMCancelableFrame::Create(frame->Task, cancellationToken);
+	}
+
+	void XnMOpenNIContextEx::EnsureUpdateSignal()
+	{
+		Monitor::Enter(m_updateLock);
+		try
+		{
+			if (m_pUpdateSignal == NULL)
+			{
+				m_pUpdateSignal = new Native::UpdateSignal();
+				m_anyDataHandle = gcnew XnMNativeWaitHandle(IntPtr(m_pUpdateSignal->GetAnyDataEvent()));
+			}
+
+			if (!m_pUpdateSignal->IsAttached())
+			{
+				XnStatus status = m_pUpdateSignal->Attach(*m_pniContext);
+				if (status != XN_STATUS_OK)
+				{
+					XnMHelper::ThrowErrorException("Failed to register for new data notifications", status);
+				}
+			}
+		}
+		finally
+		{
+			Monitor::Exit(m_updateLock);
+		}
+	}
+
+	bool XnMOpenNIContextEx::WaitSignalAndUpdate(bool waitForAll, Int32 timeoutMilliseconds)
+	{
+		if (timeoutMilliseconds < Timeout::Infinite)
+		{
+			XnMHelper::ThrowErrorException("Timeout must be positive or Timeout.Infinite", XN_STATUS_BAD_PARAM);
+		}
+
+		EnsureUpdateSignal();
+
+		// Timeout::Infinite (-1) maps to the native INFINITE
+		XnStatus status = m_pUpdateSignal->Wait(waitForAll, (XnUInt32)timeoutMilliseconds);
+		if (status == XN_STATUS_WAIT_DATA_TIMEOUT)
+			return false;
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Wait failed", status);
+		}
+
+		Monitor::Enter(m_updateLock);
+		try
+		{
+			m_pUpdateSignal->Reset();
+			status = this->m_pniContext->WaitNoneUpdateAll();
+			m_pUpdateSignal->Rearm();
+			m_nFrameNumber++;
+		}
+		finally
+		{
+			Monitor::Exit(m_updateLock);
+		}
+
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Update failed", status);
+		}
+		PublishFrame();
+		return true;
+	}
+
+	void XnMOpenNIContextEx::OnFrameSignaled(Object^ state, bool timedOut)
+	{
+		TaskCompletionSource<UInt32>^ frame;
+		RegisteredWaitHandle^ wait;
+		XnStatus status = XN_STATUS_OK;
+		UInt32 frameNumber = 0;
+
+		Monitor::Enter(m_updateLock);
+		try
+		{
+			frame = m_pendingFrame;
+			m_pendingFrame = nullptr;
+
+			// taken under the lock so a concurrent cancel does not wait for this callback
+			wait = m_pendingWait;
+			m_pendingWait = nullptr;
+			if (frame == nullptr)
+				return;
+
+			m_pUpdateSignal->Reset();
+			status = this->m_pniContext->WaitNoneUpdateAll();
+			m_pUpdateSignal->Rearm();
+			frameNumber = ++m_nFrameNumber;
+
+			// thread pool callback, failures are reported through the task
+			if (status == XN_STATUS_OK && m_pPublisher != NULL)
+				status = m_pPublisher->Publish();
+		}
+		finally
+		{
+			Monitor::Exit(m_updateLock);
+		}
+
+		if (wait != nullptr)
+			wait->Unregister(nullptr);
+
+		// complete outside of the lock, continuations may request the next frame
+		if (status != XN_STATUS_OK)
+			frame->TrySetException(gcnew XnMException(XnMHelper::CreateErrorStr("Update failed", status), status));
+		else
+			frame->TrySetResult(frameNumber);
+	}
+
+	void XnMOpenNIContextEx::CancelPendingFrame()
+	{
+		TaskCompletionSource<UInt32>^ frame;
+		RegisteredWaitHandle^ wait;
+
+		Monitor::Enter(m_updateLock);
+		try
+		{
+			frame = m_pendingFrame;
+			m_pendingFrame = nullptr;
+			wait = m_pendingWait;
+			m_pendingWait = nullptr;
+		}
+		finally
+		{
+			Monitor::Exit(m_updateLock);
+		}
+
+		// a callback already dispatched by the thread pool still uses the native event,
+		// which must outlive it (the destructor deletes the update signal next)
+		if (wait != nullptr)
+		{
+			ManualResetEvent^ unregistered = gcnew ManualResetEvent(false);
+			if (wait->Unregister(unregistered))
+				unregistered->WaitOne();
+			unregistered->Close();
+		}
+
+		if (frame != nullptr)
+			frame->TrySetCanceled();
+	}
+
+	void XnMOpenNIContextEx::StartPublishing(String^ name)
+	{
+		StartPublishing(name, 4);
+	}
+
+	void XnMOpenNIContextEx::StartPublishing(String^ name, Int32 slotCount)
+	{
+		StopPublishing();
+
+		// the registry lists every node of the current configuration once
+		std::vector<xn::MapGenerator> generators;
+		for each (XnMProductionNode^ node in m_nodeList)
+		{
+			xn::ProductionNode* pNode = node->Node;
+			XnProductionNodeType type = pNode->GetInfo().GetDescription().Type;
+			if (type == XN_NODE_TYPE_DEPTH || type == XN_NODE_TYPE_IMAGE || 
+				type == XN_NODE_TYPE_IR || type == XN_NODE_TYPE_SCENE)
+			{
+				generators.push_back(xn::MapGenerator(pNode->GetHandle()));
+			}
+		}
+
+		m_pPublisher = new Native::SharedFramePublisher();
+
+		wchar_t* strName = (wchar_t*)(void*)Marshal::StringToHGlobalUni(name);
+		XnStatus status = m_pPublisher->Create(strName, (XnUInt32)slotCount, generators);
+		Marshal::FreeHGlobal((IntPtr)strName);
+
+		if (status != XN_STATUS_OK)
+		{
+			StopPublishing();
+			XnMHelper::ThrowErrorException("Failed to create shared frame ring " + name, status);
+		}
+	}
+
+	void XnMOpenNIContextEx::StopPublishing()
+	{
+		delete m_pPublisher;
+		m_pPublisher = NULL;
+	}
+
+	void XnMOpenNIContextEx::PublishFrame()
+	{
+		if (m_pPublisher == NULL)
+			return;
+
+		XnStatus status = m_pPublisher->Publish();
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to publish frame", status);
+		}
+	}
+
 	XnMProductionNode^ XnMOpenNIContextEx::FindExistingNode(XnMProductionNodeType nodeType)
 	{
-		XnStatus status;
+		XnMProductionNode^ node;
+		if (m_nodesByType->TryGetValue((Int32)nodeType, node))
+			return node;
 
-		xn::ProductionNode* pNode = new xn::ProductionNode();
-		status = this->m_pniContext->FindExistingNode((XnProductionNodeType)nodeType, *pNode);
+		// node created after initialization
+		xn::ProductionNode* pNode = CreateNativeNode((XnProductionNodeType)nodeType);
+		XnStatus status = this->m_pniContext->FindExistingNode((XnProductionNodeType)nodeType, *pNode);
 		if (status != XN_STATUS_OK)
 		{
+			delete pNode;
 			XnMHelper::ThrowErrorException("Failed to get production node", status);
 		}
+
+		// a node already wrapped under its name (another type's lookup entry) is not wrapped twice
+		if (m_nodesByName->TryGetValue(XnMHelper::CreateString(pNode->GetName()), node))
+		{
+			delete pNode;
+			m_nodesByType->Add((Int32)nodeType, node);
+			return node;
+		}
 		
-		//TODO: wrap in appropriate type
-		return WrapProductionNode(pNode);
+		return RegisterNode(pNode, (XnProductionNodeType)nodeType);
+	}
+
+	XnMProductionNode^ XnMOpenNIContextEx::FindExistingNode(String^ instanceName)
+	{
+		XnMProductionNode^ node;
+		if (m_nodesByName->TryGetValue(instanceName, node))
+			return node;
+
+		XnMHelper::ThrowErrorException("Failed to get production node " + instanceName, XN_STATUS_NO_MATCH);
+		return nullptr;
+	}
+
+	array<XnMProductionNode^>^ XnMOpenNIContextEx::GetExistingNodes()
+	{
+		return m_nodeList->ToArray();
+	}
+
+	xn::ProductionNode* XnMOpenNIContextEx::CreateNativeNode(XnProductionNodeType type)
+	{
+		// WrapProductionNode casts to the concrete wrapper, so allocate matching objects
+		switch(type)
+		{
+		case XN_NODE_TYPE_DEVICE:
+			return new xn::Device();
+		case XN_NODE_TYPE_DEPTH:
+			return new xn::DepthGenerator();
+		case XN_NODE_TYPE_IMAGE:
+			return new xn::ImageGenerator();
+		case XN_NODE_TYPE_SCENE:
+			return new xn::SceneAnalyzer();
+		case XN_NODE_TYPE_USER:
+			return new xn::UserGenerator();
+		case XN_NODE_TYPE_HANDS:
+			return new xn::HandsGenerator();
+		}
+		return new xn::ProductionNode();
 	}
 
 	XnMProductionNode^ XnMOpenNIContextEx::WrapProductionNode(xn::ProductionNode* pNode)
@@ -83,14 +622,17 @@ namespace ManagedNiteEx
 		switch(desc.Type)
 		{
 		case XN_NODE_TYPE_DEVICE:
-			break;
+			return gcnew XnMDevice((xn::Device*)pNode);
 		case XN_NODE_TYPE_DEPTH:
 			return gcnew XnMDepthGenerator((xn::DepthGenerator*)pNode);
-			break;
 		case XN_NODE_TYPE_IMAGE:
 			return gcnew XnMImageGenerator((xn::ImageGenerator*)pNode);
 		case XN_NODE_TYPE_SCENE:
 			return gcnew XnMSceneAnalyzer((xn::SceneAnalyzer*)pNode);
+		case XN_NODE_TYPE_USER:
+			return gcnew XnMUserGenerator((xn::UserGenerator*)pNode);
+		case XN_NODE_TYPE_HANDS:
+			return gcnew XnMHandsGenerator((xn::HandsGenerator*)pNode);
 		}
 		//TODO: store context reference
 		return gcnew XnMProductionNode(pNode);
@@ -5,6 +5,13 @@
 #include "XnMImageGenerator.h"
 #include "XnMDepthGenerator.h"
 #include "XnMSceneAnalyzer.h"
+#include "XnMUserGenerator.h"
+#include "XnMHandsGenerator.h"
+#include "XnMDevice.h"
+#include "XnMStartupTimings.h"
+#include "Native/UpdateSignal.h"
+#include "Native/GeneratorStartup.h"
+#include "Native/SharedFrameRing.h"
 
 namespace ManagedNiteEx
 {
@@ -15,9 +22,56 @@ namespace ManagedNiteEx
 		UInt32 InitFromXmlFile(String^);
 		UInt32 Shutdown();
 
+		// The blocking waits below hold the update lock while OpenNI waits, so awaitable 
+		// and timeout-bounded waits of other threads run after them.
+
+		// Waits for all generators to have new data and updates them.
 		UInt32 WaitAndUpdateAll();
 
+		// Waits for any generator to have new data and updates all of them.
+		UInt32 WaitAnyUpdateAll();
+
+		// Waits for the given node to have new data and updates all generators.
+		UInt32 WaitOneUpdateAll(XnMProductionNode^ node);
+
+		// Updates all generators with whatever data is available, without waiting.
+		UInt32 WaitNoneUpdateAll();
+
+		// Timeout-bounded variants. Return false (without updating) when the timeout elapsed.
+		// The timeout must not be negative except for Timeout.Infinite (-1).
+		bool WaitAndUpdateAll(Int32 timeoutMilliseconds);
+		bool WaitAnyUpdateAll(Int32 timeoutMilliseconds);
+
+		// Returns a task that completes with the frame number after the next update triggered 
+		// by new data on any generator. All pending callers share one native wait.
+		System::Threading::Tasks::Task<UInt32>^ WaitForFrameAsync();
+		System::Threading::Tasks::Task<UInt32>^ WaitForFrameAsync(System::Threading::CancellationToken cancellationToken);
+
+		// Gets the number of updates performed by all waits.
+		property UInt32 FrameNumber { 
+			UInt32 get() { return m_nFrameNumber; }
+		}
+
+		// Publishes every updated frame set of the map generators into a named shared memory 
+		// ring that other processes read with XnMSharedFrameSubscriber.
+		void StartPublishing(String^ name);
+		void StartPublishing(String^ name, Int32 slotCount);
+		void StopPublishing();
+
+		property bool IsPublishing { 
+			bool get() { return m_pPublisher != NULL && m_pPublisher->IsOpen(); }
+		}
+
+		// Node lookups are served from the registry built by InitFromXmlFile.
+		// Returned nodes stay valid until Shutdown, also across repeated InitFromXmlFile calls.
 		XnMProductionNode^ FindExistingNode(XnMProductionNodeType);
+		XnMProductionNode^ FindExistingNode(String^ instanceName);
+		array<XnMProductionNode^>^ GetExistingNodes();
+
+		// Gets the phase durations of the last InitFromXmlFile call.
+		property XnMStartupTimings^ StartupTimings { 
+			XnMStartupTimings^ get() { return m_startupTimings; }
+		}
 
 	internal:
 		property xn::Context* Context { 
@@ -27,8 +81,40 @@ namespace ManagedNiteEx
 	private:
 		~XnMOpenNIContextEx();
 		XnMProductionNode^ WrapProductionNode(xn::ProductionNode*);
+		static xn::ProductionNode* CreateNativeNode(XnProductionNodeType);
+
+		XnStatus BuildNodeRegistry(std::vector<xn::Generator>& generators);
+		XnMProductionNode^ RegisterNode(xn::ProductionNode*, XnProductionNodeType);
+		void AddNodeLookup(XnMProductionNode^, XnProductionNodeType);
+		void ClearNodeLookup();
+		void ClearNodeRegistry();
+
+		void EnsureUpdateSignal();
+		bool WaitSignalAndUpdate(bool waitForAll, Int32 timeoutMilliseconds);
+		XnStatus BlockingUpdate(XnStatus (*pUpdate)(xn::Context&, xn::ProductionNode*), xn::ProductionNode* pNode);
+		void OnFrameSignaled(Object^ state, bool timedOut);
+		void CancelPendingFrame();
+		void PublishFrame();
 
 		xn::Context* m_pniContext;
+
+		// native nodes of every wrapper handed out, each holds a reference until Shutdown.
+		// Re-initialization reuses them by instance name.
+		std::vector<xn::ProductionNode*>* m_pNodes;
+		// their wrappers, detached before the nodes are deleted
+		System::Collections::Generic::List<XnMProductionNode^>^ m_nodeWrappers;
+		System::Collections::Generic::Dictionary<Int32, XnMProductionNode^>^ m_nodesByType;
+		System::Collections::Generic::Dictionary<String^, XnMProductionNode^>^ m_nodesByName;
+		System::Collections::Generic::List<XnMProductionNode^>^ m_nodeList;
+		XnMStartupTimings^ m_startupTimings;
+
+		Native::UpdateSignal* m_pUpdateSignal;
+		System::Threading::WaitHandle^ m_anyDataHandle;
+		System::Threading::Tasks::TaskCompletionSource<UInt32>^ m_pendingFrame;
+		System::Threading::RegisteredWaitHandle^ m_pendingWait;
+		Object^ m_updateLock;
+		UInt32 m_nFrameNumber;
+
+		Native::SharedFramePublisher* m_pPublisher;
 	};
 }
-
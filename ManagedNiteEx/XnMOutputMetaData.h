@@ -15,6 +15,11 @@ namespace ManagedNiteEx
 			DateTime^ get() { return gcnew DateTime(m_pOutputMeta->Timestamp()); } 
 		};
 		
+		// Gets the timestamp in microseconds without converting it.
+		property UInt64 RawTimestamp { 
+			UInt64 get() { return m_pOutputMeta->Timestamp(); } 
+		};
+
 		property UInt32 FrameID { 
 			UInt32 get() { return m_pOutputMeta->FrameID(); } 
 		};
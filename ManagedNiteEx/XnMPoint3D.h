@@ -0,0 +1,19 @@
+#pragma once
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Point in projective or real world coordinates, layout compatible with XnPoint3D
+	/// </summary>
+	public value struct XnMPoint3D
+	{
+	public:
+		XnMPoint3D(Single x, Single y, Single z)
+			: X(x), Y(y), Z(z)
+		{ }
+
+		Single X;
+		Single Y;
+		Single Z;
+	};
+}
@@ -0,0 +1,96 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMPointCloudExporter.h"
+
+namespace ManagedNiteEx
+{
+	XnMPointCloudExporter::XnMPointCloudExporter(XnMPointCloudFormat format)
+	{
+		this->m_pWriter = new Native::PointCloudWriter((Native::PointCloudWriter::Format)format);
+	}
+
+	XnMPointCloudExporter::~XnMPointCloudExporter()
+	{
+		delete m_pWriter;
+		m_pWriter = NULL;
+	}
+
+	void XnMPointCloudExporter::SetIntrinsics(Single focalLength, Single centerX, Single centerY)
+	{
+		m_pWriter->SetIntrinsics(Native::DepthIntrinsics::Create(focalLength, centerX, centerY));
+	}
+
+	void XnMPointCloudExporter::SetIntrinsics(XnMDepthGenerator^ generator)
+	{
+		m_pWriter->SetIntrinsics(generator->GetIntrinsics());
+	}
+
+	const XnUInt8* XnMPointCloudExporter::GetColor(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta)
+	{
+		if (imageMeta == nullptr)
+			return NULL;
+
+		if (imageMeta->PixelFormat != XnMPixelFormat::Rgb24)
+			XnMHelper::ThrowErrorException("Only RGB24 images can color point clouds", XN_STATUS_BAD_PARAM);
+
+		xn::DepthMetaData* pDepth = depthMeta->MetaData;
+		xn::MapMetaData* pImage = imageMeta->MetaData;
+		if (pImage->XRes() != pDepth->XRes() || pImage->YRes() != pDepth->YRes())
+			XnMHelper::ThrowErrorException("Image must be registered to the depth map", XN_STATUS_BAD_PARAM);
+
+		return (const XnUInt8*)pImage->Data();
+	}
+
+	Int32 XnMPointCloudExporter::Export(String^ path, XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta)
+	{
+		xn::DepthMetaData* pDepth = depthMeta->MetaData;
+		XnUInt32 nPoints = m_pWriter->Convert(pDepth->Data(), GetColor(depthMeta, imageMeta), 
+			pDepth->XRes(), pDepth->YRes(), pDepth->FrameID());
+
+		wchar_t* strPath = (wchar_t*)(void*)Marshal::StringToHGlobalUni(path);
+		XnStatus status = m_pWriter->Write(strPath);
+		Marshal::FreeHGlobal((IntPtr)strPath);
+
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to write point cloud " + path, status);
+		}
+		return nPoints;
+	}
+
+	void XnMPointCloudExporter::BeginSession(String^ directory, String^ prefix)
+	{
+		wchar_t* strDirectory = (wchar_t*)(void*)Marshal::StringToHGlobalUni(directory);
+		wchar_t* strPrefix = (wchar_t*)(void*)Marshal::StringToHGlobalUni(prefix);
+		XnStatus status = m_pWriter->BeginStream(strDirectory, strPrefix);
+		Marshal::FreeHGlobal((IntPtr)strPrefix);
+		Marshal::FreeHGlobal((IntPtr)strDirectory);
+
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to start point cloud session", status);
+		}
+	}
+
+	Int32 XnMPointCloudExporter::ExportFrame(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta)
+	{
+		xn::DepthMetaData* pDepth = depthMeta->MetaData;
+		XnUInt32 nPoints = 0;
+		XnStatus status = m_pWriter->StreamFrame(pDepth->Data(), GetColor(depthMeta, imageMeta), 
+			pDepth->XRes(), pDepth->YRes(), pDepth->FrameID(), nPoints);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to export point cloud frame", status);
+		}
+		return nPoints;
+	}
+
+	void XnMPointCloudExporter::EndSession()
+	{
+		XnStatus status = m_pWriter->EndStream();
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to write point cloud frames", status);
+		}
+	}
+}
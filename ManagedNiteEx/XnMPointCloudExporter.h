@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "XnMDepthGenerator.h"
+#include "XnMDepthMetaData.h"
+#include "XnMImageMetaData.h"
+#include "Native/PointCloudWriter.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Writes depth frames, optionally colored by a registered RGB24 image, as binary 
+	/// PLY or PCD point clouds in real world coordinates. A session streams every frame
+	/// to its own file while the next frame is being converted.
+	/// </summary>
+	public ref class XnMPointCloudExporter
+	{
+	public:
+		XnMPointCloudExporter(XnMPointCloudFormat format);
+
+		void SetIntrinsics(Single focalLength, Single centerX, Single centerY);
+		// Uses the zero plane distance and pixel size (ZPD, ZPPS) of the depth generator.
+		void SetIntrinsics(XnMDepthGenerator^ generator);
+
+		// Writes one frame to the file. imageMeta may be null. Returns the number of points.
+		Int32 Export(String^ path, XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta);
+
+		// Starts writing frames to <directory>\<prefix>_<frame id>.<ply|pcd>.
+		void BeginSession(String^ directory, String^ prefix);
+		// Converts the frame and queues it for writing. Returns the number of points.
+		Int32 ExportFrame(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta);
+		// Waits until all frames are written.
+		void EndSession();
+
+		property XnMPointCloudFormat Format { 
+			XnMPointCloudFormat get() { return (XnMPointCloudFormat)m_pWriter->GetFormat(); } 
+		};
+
+		// Gets or sets the factor applied to coordinates in millimeters (0.001 writes meters).
+		property Single Scale { 
+			Single get() { return m_pWriter->GetScale(); } 
+			void set(Single value) { m_pWriter->SetScale(value); }
+		};
+
+		property bool IsSessionActive { 
+			bool get() { return m_pWriter->IsStreaming(); } 
+		};
+
+		// Gets the number of bytes written since the session started.
+		property UInt64 BytesWritten { 
+			UInt64 get() { return m_pWriter->GetBytesWritten(); } 
+		};
+
+	private:
+		~XnMPointCloudExporter();
+
+		const XnUInt8* GetColor(XnMDepthMetaData^ depthMeta, XnMImageMetaData^ imageMeta);
+
+		Native::PointCloudWriter* m_pWriter;
+	};
+}
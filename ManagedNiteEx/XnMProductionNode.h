@@ -12,6 +12,14 @@ namespace ManagedNiteEx
 	internal:
 		XnMProductionNode(xn::ProductionNode*);
 
+		property xn::ProductionNode* Node { 
+			xn::ProductionNode* get() { return this->m_pNode; }
+		}
+
+		// Releases native state bound to the node (callbacks, trackers) before the context
+		// shuts the node down. Later use of that state throws ObjectDisposedException.
+		virtual void Detach() {}
+
 	public:
 		XnMNodeInfo^ GetNodeInfo();
 
@@ -1,4 +1,5 @@
 #include "StdAfx.h"
+#include "XnMHelper.h"
 #include "XnMSceneAnalyzer.h"
 
 namespace ManagedNiteEx 
@@ -18,5 +19,25 @@ namespace ManagedNiteEx
 	{
 		xn::SceneMetaData* nativeMeta = (xn::SceneMetaData*)sceneMetaData->GetNativeObject();
 		m_pSceneAnalyzer->GetMetaData(*nativeMeta);
+		sceneMetaData->UpdateHeader();
+	}
+
+	void XnMSceneAnalyzer::GetMetaData(XnMSceneMetaData^ metaData, [Out] XnMFrameHeader% header)
+	{
+		GetMetaData(metaData);
+		header = metaData->Header;
+	}
+
+	void XnMSceneAnalyzer::GetFloor([Out] XnMPoint3D% point, [Out] XnMPoint3D% normal)
+	{
+		XnPlane3D plane;
+		XnStatus status = m_pSceneAnalyzer->GetFloor(plane);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to get floor", status);
+		}
+
+		point = XnMPoint3D(plane.ptPoint.X, plane.ptPoint.Y, plane.ptPoint.Z);
+		normal = XnMPoint3D(plane.vNormal.X, plane.vNormal.Y, plane.vNormal.Z);
 	}
 }
@@ -2,6 +2,7 @@
 
 #include "XnMMapGenerator.h"
 #include "XnMSceneMetaData.h"
+#include "XnMPoint3D.h"
 
 namespace ManagedNiteEx 
 {
@@ -14,8 +15,12 @@ namespace ManagedNiteEx
 		~XnMSceneAnalyzer();
 	public:
 		void GetMetaData(XnMSceneMetaData^);
+		// Also returns the snapshot of the metadata (same as its Header property).
+		void GetMetaData(XnMSceneMetaData^ metaData, [Out] XnMFrameHeader% header);
 		//XnMLabel GetLabelMap();
-		//GetFloor(XnMPlane3D);
+
+		// Gets a point on the floor and the floor normal in real world coordinates.
+		void GetFloor([Out] XnMPoint3D% point, [Out] XnMPoint3D% normal);
 	protected:
 		xn::SceneAnalyzer* m_pSceneAnalyzer;
 	};
@@ -0,0 +1,59 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMSharedFrameSubscriber.h"
+
+namespace ManagedNiteEx
+{
+	XnMSharedFrameSubscriber::XnMSharedFrameSubscriber(String^ name)
+	{
+		this->m_pSubscriber = new Native::SharedFrameSubscriber();
+
+		wchar_t* strName = (wchar_t*)(void*)Marshal::StringToHGlobalUni(name);
+		XnStatus status = m_pSubscriber->Open(strName);
+		Marshal::FreeHGlobal((IntPtr)strName);
+		if (status != XN_STATUS_OK)
+		{
+			delete m_pSubscriber;
+			m_pSubscriber = NULL;
+			XnMHelper::ThrowErrorException("Failed to open shared frame ring " + name, status);
+		}
+	}
+
+	XnMSharedFrameSubscriber::~XnMSharedFrameSubscriber()
+	{
+		delete m_pSubscriber;
+		m_pSubscriber = NULL;
+	}
+
+	bool XnMSharedFrameSubscriber::WaitForFrame(Int32 timeoutMilliseconds)
+	{
+		XnStatus status = m_pSubscriber->AcquireLatest((XnUInt32)timeoutMilliseconds);
+		if (status == XN_STATUS_WAIT_DATA_TIMEOUT)
+			return false;
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to read shared frame", status);
+		}
+		return true;
+	}
+
+	bool XnMSharedFrameSubscriber::GetMetaData(XnMProductionNodeType nodeType, XnMMapMetaData^ metaData)
+	{
+		const Native::SharedStreamHeader* pStream = m_pSubscriber->FindStream((XnUInt32)nodeType);
+		if (pStream == NULL || pStream->nDataSize == 0)
+			return false;
+
+		m_pSubscriber->FillMetaData(pStream, *metaData->MetaData);
+		metaData->UpdateHeader();
+		return true;
+	}
+
+	XnMProductionNodeType XnMSharedFrameSubscriber::GetStreamType(Int32 index)
+	{
+		const Native::SharedStreamHeader* pStream = m_pSubscriber->GetStream((XnUInt32)index);
+		if (pStream == NULL)
+			throw gcnew ArgumentOutOfRangeException("index");
+
+		return (XnMProductionNodeType)pStream->nNodeType;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "XnMMapMetaData.h"
+#include "Native/SharedFrameRing.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Reads frame sets published by an XnMOpenNIContextEx in another process 
+	/// (see XnMOpenNIContextEx::StartPublishing). Frames are read in place from shared memory.
+	/// </summary>
+	public ref class XnMSharedFrameSubscriber
+	{
+	public:
+		XnMSharedFrameSubscriber(String^ name);
+
+		// Acquires the newest frame set. Frames the subscriber was too slow for are skipped.
+		// Returns false if no new frame set was published within the timeout.
+		bool WaitForFrame(Int32 timeoutMilliseconds);
+
+		// Points the metadata at the data of the given stream in the acquired frame set.
+		// The data stays valid while IsFrameValid returns true.
+		bool GetMetaData(XnMProductionNodeType nodeType, XnMMapMetaData^ metaData);
+
+		XnMProductionNodeType GetStreamType(Int32 index);
+
+		// Gets whether the acquired frame set is still intact (not yet overwritten by the publisher).
+		// Check after processing the data to detect torn reads.
+		property bool IsFrameValid { 
+			bool get() { return m_pSubscriber->IsAcquiredValid(); } 
+		};
+
+		property Int32 StreamCount { 
+			Int32 get() { return m_pSubscriber->GetStreamCount(); } 
+		};
+
+		// Gets the sequence number of the acquired frame set.
+		property UInt32 Sequence { 
+			UInt32 get() { return m_pSubscriber->GetSequence(); } 
+		};
+
+		// Gets the number of frame sets skipped because the subscriber was too slow.
+		property UInt32 SkippedFrames { 
+			UInt32 get() { return m_pSubscriber->GetSkippedCount(); } 
+		};
+
+	private:
+		~XnMSharedFrameSubscriber();
+
+		Native::SharedFrameSubscriber* m_pSubscriber;
+	};
+}
@@ -0,0 +1,27 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMSkeletonFrame.h"
+
+namespace ManagedNiteEx
+{
+	XnMSkeletonFrame::XnMSkeletonFrame(Int32 maxUsers)
+	{
+		if (maxUsers <= 0)
+			XnMHelper::ThrowErrorException("Invalid number of users", XN_STATUS_BAD_PARAM);
+
+		this->m_users = gcnew array<XnMUserSkeleton>(maxUsers);
+		this->m_joints = gcnew array<XnMSkeletonJoint>(maxUsers * JointCount);
+		this->m_nUserCount = 0;
+		this->m_nTimestamp = 0;
+		this->m_nFrameID = 0;
+	}
+
+	XnMSkeletonJoint XnMSkeletonFrame::GetJoint(Int32 userIndex, XnMSkeletonJointType joint)
+	{
+		Int32 index = (Int32)joint - 1;
+		if (userIndex < 0 || userIndex >= m_nUserCount || index < 0 || index >= JointCount)
+			XnMHelper::ThrowErrorException("Invalid user or joint", XN_STATUS_BAD_PARAM);
+
+		return m_joints[userIndex * JointCount + index];
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "XnMPoint3D.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Joint position (real world, mm) with its confidence, layout compatible with the native record
+	/// </summary>
+	public value struct XnMSkeletonJoint
+	{
+	public:
+		Single X;
+		Single Y;
+		Single Z;
+		Single Confidence;
+	};
+
+	/// <summary>
+	/// User entry of a skeleton frame, layout compatible with the native record
+	/// </summary>
+	public value struct XnMUserSkeleton
+	{
+	public:
+		UInt32 UserId;
+		XnMSkeletonState State;
+		XnMPoint3D CenterOfMass;
+	};
+
+	/// <summary>
+	/// Reusable container for the skeletons of all users of one frame. 
+	/// Filling it does not allocate once it has been created.
+	/// </summary>
+	public ref class XnMSkeletonFrame
+	{
+	public:
+		// Number of joint slots per user (indexed by XnMSkeletonJointType - 1)
+		static const Int32 JointCount = (Int32)XnMSkeletonJointType::RightFoot;
+
+		XnMSkeletonFrame(Int32 maxUsers);
+
+		// Gets a joint of the user at the given index of Users.
+		XnMSkeletonJoint GetJoint(Int32 userIndex, XnMSkeletonJointType joint);
+
+		// Gets the users, only the first UserCount entries are valid.
+		property array<XnMUserSkeleton>^ Users { 
+			array<XnMUserSkeleton>^ get() { return m_users; } 
+		};
+
+		// Gets the joints, JointCount entries per user.
+		property array<XnMSkeletonJoint>^ Joints { 
+			array<XnMSkeletonJoint>^ get() { return m_joints; } 
+		};
+
+		property Int32 UserCount { 
+			Int32 get() { return m_nUserCount; } 
+		};
+
+		property Int32 MaxUsers { 
+			Int32 get() { return m_users->Length; } 
+		};
+
+		property UInt64 Timestamp { 
+			UInt64 get() { return m_nTimestamp; } 
+		};
+
+		property UInt32 FrameID { 
+			UInt32 get() { return m_nFrameID; } 
+		};
+
+	internal:
+		void SetFrame(Int32 userCount, UInt64 timestamp, UInt32 frameID)
+		{
+			m_nUserCount = userCount;
+			m_nTimestamp = timestamp;
+			m_nFrameID = frameID;
+		}
+
+	private:
+		array<XnMUserSkeleton>^ m_users;
+		array<XnMSkeletonJoint>^ m_joints;
+		Int32 m_nUserCount;
+		UInt64 m_nTimestamp;
+		UInt32 m_nFrameID;
+	};
+}
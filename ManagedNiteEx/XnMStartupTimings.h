@@ -0,0 +1,51 @@
+#pragma once
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Durations of the context startup phases
+	/// </summary>
+	public ref class XnMStartupTimings
+	{
+	internal:
+		XnMStartupTimings() { }
+
+	public:
+		// Gets the time spent parsing the XML and creating the nodes.
+		property TimeSpan XmlInit { 
+			TimeSpan get() { return m_xmlInit; } 
+		};
+
+		// Gets the time spent enumerating and wrapping the existing nodes.
+		property TimeSpan NodeRegistry { 
+			TimeSpan get() { return m_nodeRegistry; } 
+		};
+
+		// Gets the time spent starting the generators (they are started concurrently).
+		property TimeSpan GeneratorStart { 
+			TimeSpan get() { return m_generatorStart; } 
+		};
+
+		// Gets the longest start time of a single generator.
+		property TimeSpan SlowestGenerator { 
+			TimeSpan get() { return m_slowestGenerator; } 
+		};
+
+		property TimeSpan Total { 
+			TimeSpan get() { return m_xmlInit + m_nodeRegistry + m_generatorStart; } 
+		};
+
+		virtual String^ ToString() override
+		{
+			return String::Format("XML init: {0} ms, node registry: {1} ms, generator start: {2} ms (slowest {3} ms), total: {4} ms",
+				m_xmlInit.TotalMilliseconds, m_nodeRegistry.TotalMilliseconds, m_generatorStart.TotalMilliseconds,
+				m_slowestGenerator.TotalMilliseconds, Total.TotalMilliseconds);
+		}
+
+	internal:
+		TimeSpan m_xmlInit;
+		TimeSpan m_nodeRegistry;
+		TimeSpan m_generatorStart;
+		TimeSpan m_slowestGenerator;
+	};
+}
@@ -0,0 +1,55 @@
+#include "StdAfx.h"
+#include "XnMTileTracker.h"
+
+namespace ManagedNiteEx
+{
+	XnMTileTracker::XnMTileTracker()
+	{
+		this->m_pTracker = new Native::TileTracker(16, 0, 0);
+	}
+
+	XnMTileTracker::XnMTileTracker(UInt32 tileSize, UInt32 depthTolerance, UInt32 colorTolerance)
+	{
+		this->m_pTracker = new Native::TileTracker(tileSize, depthTolerance, colorTolerance);
+	}
+
+	XnMTileTracker::~XnMTileTracker()
+	{
+		delete m_pTracker;
+		m_pTracker = NULL;
+	}
+
+	UInt32 XnMTileTracker::Update(XnMMapMetaData^ metaData)
+	{
+		xn::MapMetaData* pMeta = metaData->MetaData;
+
+		m_nXOffset = pMeta->XOffset();
+		m_nYOffset = pMeta->YOffset();
+
+		return m_pTracker->Update(pMeta->Data(), pMeta->XRes(), pMeta->YRes(), pMeta->BytesPerPixel());
+	}
+
+	void XnMTileTracker::Reset()
+	{
+		m_pTracker->Reset();
+	}
+
+	bool XnMTileTracker::IsTileDirty(UInt32 tileX, UInt32 tileY)
+	{
+		return m_pTracker->IsTileDirty(tileX, tileY);
+	}
+
+	array<XnMRect>^ XnMTileTracker::GetDirtyRects()
+	{
+		UInt32 count = m_pTracker->GetDirtyRectCount();
+		const Native::DirtyRect* pRects = m_pTracker->GetDirtyRects();
+
+		array<XnMRect>^ rects = gcnew array<XnMRect>(count);
+		for (UInt32 i = 0; i < count; i++)
+		{
+			rects[i] = XnMRect(pRects[i].X + m_nXOffset, pRects[i].Y + m_nYOffset, 
+				pRects[i].Width, pRects[i].Height);
+		}
+		return rects;
+	}
+}
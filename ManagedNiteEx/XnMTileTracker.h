@@ -0,0 +1,84 @@
+#pragma once
+
+#include "XnMMapMetaData.h"
+#include "Native/TileTracker.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Rectangle in full frame pixel coordinates
+	/// </summary>
+	public value struct XnMRect
+	{
+	public:
+		XnMRect(Int32 x, Int32 y, Int32 width, Int32 height)
+			: X(x), Y(y), Width(width), Height(height)
+		{ }
+
+		Int32 X;
+		Int32 Y;
+		Int32 Width;
+		Int32 Height;
+	};
+
+	/// <summary>
+	/// Tracks which tiles of a stream changed between consecutive frames so consumers 
+	/// can update only the dirty regions of their bitmaps or buffers.
+	/// </summary>
+	public ref class XnMTileTracker
+	{
+	public:
+		XnMTileTracker();
+		XnMTileTracker(UInt32 tileSize, UInt32 depthTolerance, UInt32 colorTolerance);
+
+		// Compares the frame with the previous one. Returns the number of dirty rectangles.
+		UInt32 Update(XnMMapMetaData^ metaData);
+
+		// Marks the whole next frame as dirty.
+		void Reset();
+
+		bool IsTileDirty(UInt32 tileX, UInt32 tileY);
+
+		// Gets the dirty rectangles of the last update, offset by the crop position.
+		array<XnMRect>^ GetDirtyRects();
+
+		property UInt32 TileSize { 
+			UInt32 get() { return m_pTracker->GetTileSize(); } 
+		};
+
+		property UInt32 TilesX { 
+			UInt32 get() { return m_pTracker->GetTilesX(); } 
+		};
+
+		property UInt32 TilesY { 
+			UInt32 get() { return m_pTracker->GetTilesY(); } 
+		};
+
+		// Gets or sets the tolerance (in depth units) used for 16-bit maps.
+		property UInt32 DepthTolerance { 
+			UInt32 get() { return m_pTracker->GetDepthTolerance(); } 
+			void set(UInt32 value) { m_pTracker->SetDepthTolerance(value); }
+		};
+
+		// Gets or sets the per-channel tolerance used for 8-bit maps.
+		property UInt32 ColorTolerance { 
+			UInt32 get() { return m_pTracker->GetColorTolerance(); } 
+			void set(UInt32 value) { m_pTracker->SetColorTolerance(value); }
+		};
+
+		property UInt32 DirtyTileCount { 
+			UInt32 get() { return m_pTracker->GetDirtyTileCount(); } 
+		};
+
+		property UInt32 DirtyRectCount { 
+			UInt32 get() { return m_pTracker->GetDirtyRectCount(); } 
+		};
+
+	private:
+		~XnMTileTracker();
+
+		Native::TileTracker* m_pTracker;
+		Int32 m_nXOffset;
+		Int32 m_nYOffset;
+	};
+}
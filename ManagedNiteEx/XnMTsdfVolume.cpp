@@ -0,0 +1,124 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMTsdfVolume.h"
+
+namespace ManagedNiteEx
+{
+	XnMTsdfVolume::XnMTsdfVolume(Single voxelSize, Single truncation, Int32 maxBlocks)
+	{
+		if (voxelSize <= 0 || truncation <= 0 || maxBlocks <= 0)
+			XnMHelper::ThrowErrorException("Invalid volume parameters", XN_STATUS_BAD_PARAM);
+
+		this->m_pVolume = new Native::TsdfVolume(voxelSize, truncation, maxBlocks);
+		this->m_pIntrinsics = new Native::DepthIntrinsics();
+		this->m_bHasIntrinsics = false;
+	}
+
+	XnMTsdfVolume::~XnMTsdfVolume()
+	{
+		delete m_pVolume;
+		m_pVolume = NULL;
+		delete m_pIntrinsics;
+		m_pIntrinsics = NULL;
+	}
+
+	Native::RigidTransform XnMTsdfVolume::ToRigidTransform(array<Single>^ pose)
+	{
+		if (pose == nullptr)
+			return Native::RigidTransform::Identity();
+
+		if (pose->Length != 16)
+			XnMHelper::ThrowErrorException("Pose must be a 4x4 matrix", XN_STATUS_BAD_PARAM);
+
+		pin_ptr<Single> pPose = &pose[0];
+		return Native::RigidTransform::FromMatrix4x4(pPose);
+	}
+
+	void XnMTsdfVolume::SetIntrinsics(Single focalLength, Single centerX, Single centerY)
+	{
+		*m_pIntrinsics = Native::DepthIntrinsics::Create(focalLength, centerX, centerY);
+		m_bHasIntrinsics = true;
+	}
+
+	void XnMTsdfVolume::SetIntrinsics(XnMDepthGenerator^ generator)
+	{
+		*m_pIntrinsics = generator->GetIntrinsics();
+		m_bHasIntrinsics = true;
+	}
+
+	void XnMTsdfVolume::Integrate(XnMDepthMetaData^ depthMeta)
+	{
+		Integrate(depthMeta, nullptr);
+	}
+
+	void XnMTsdfVolume::Integrate(XnMDepthMetaData^ depthMeta, array<Single>^ pose)
+	{
+		if (!m_bHasIntrinsics)
+			XnMHelper::ThrowErrorException("Intrinsics have not been set", XN_STATUS_BAD_PARAM);
+
+		xn::DepthMetaData* pMeta = depthMeta->MetaData;
+		XnStatus status = m_pVolume->Integrate(pMeta->Data(), pMeta->XRes(), pMeta->YRes(), 
+			*m_pIntrinsics, ToRigidTransform(pose));
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to integrate depth frame", status);
+		}
+	}
+
+	void XnMTsdfVolume::Raycast(array<Single>^ pose, IntPtr depth, IntPtr normals, Int32 width, Int32 height)
+	{
+		if (!m_bHasIntrinsics)
+			XnMHelper::ThrowErrorException("Intrinsics have not been set", XN_STATUS_BAD_PARAM);
+		if (depth == IntPtr::Zero || width <= 0 || height <= 0)
+			XnMHelper::ThrowErrorException("Invalid raycast target", XN_STATUS_BAD_PARAM);
+
+		m_pVolume->Raycast(*m_pIntrinsics, ToRigidTransform(pose), width, height, 
+			(XnUInt16*)depth.ToPointer(), (float*)normals.ToPointer());
+	}
+
+	Int32 XnMTsdfVolume::UpdateMesh()
+	{
+		return m_pVolume->UpdateMesh();
+	}
+
+	array<Single>^ XnMTsdfVolume::GetMeshTriangles()
+	{
+		array<Single>^ vertices = gcnew array<Single>(m_pVolume->GetTriangleCount() * 9);
+		if (vertices->Length > 0)
+		{
+			pin_ptr<Single> pVertices = &vertices[0];
+			m_pVolume->CopyTriangles(pVertices);
+		}
+		return vertices;
+	}
+
+	array<Int32>^ XnMTsdfVolume::GetUpdatedBlocks()
+	{
+		const std::vector<XnUInt32>& blocks = m_pVolume->GetUpdatedBlocks();
+		array<Int32>^ result = gcnew array<Int32>((Int32)blocks.size());
+		for (Int32 i = 0; i < result->Length; ++i)
+		{
+			result[i] = blocks[i];
+		}
+		return result;
+	}
+
+	array<Single>^ XnMTsdfVolume::GetBlockTriangles(Int32 block)
+	{
+		if (block < 0 || block >= (Int32)m_pVolume->GetBlockCount())
+			XnMHelper::ThrowErrorException("Invalid block index", XN_STATUS_BAD_PARAM);
+
+		const std::vector<float>& triangles = m_pVolume->GetBlockTriangles(block);
+		array<Single>^ result = gcnew array<Single>((Int32)triangles.size());
+		if (result->Length > 0)
+		{
+			Marshal::Copy(IntPtr((void*)&triangles[0]), result, 0, result->Length);
+		}
+		return result;
+	}
+
+	void XnMTsdfVolume::Reset()
+	{
+		m_pVolume->Reset();
+	}
+}
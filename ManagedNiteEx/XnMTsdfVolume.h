@@ -0,0 +1,100 @@
+#pragma once
+
+#include "XnMDepthGenerator.h"
+#include "XnMDepthMetaData.h"
+#include "Native/TsdfVolume.h"
+
+namespace ManagedNiteEx
+{
+	/// <summary>
+	/// Fuses depth frames into a sparse truncated signed distance volume that can be 
+	/// rendered back into depth and normal maps and extracted as a triangle mesh.
+	/// Poses are row-major 4x4 camera-to-world matrices in millimeters.
+	/// </summary>
+	public ref class XnMTsdfVolume
+	{
+	public:
+		// Creates a volume with given voxel size and truncation distance (mm). 
+		// At most maxBlocks blocks of 8x8x8 voxels are allocated.
+		XnMTsdfVolume(Single voxelSize, Single truncation, Int32 maxBlocks);
+
+		// Sets the pinhole model used to project depth frames.
+		void SetIntrinsics(Single focalLength, Single centerX, Single centerY);
+		// Reads the intrinsics from the zero plane properties of the depth generator.
+		void SetIntrinsics(XnMDepthGenerator^ generator);
+
+		// Fuses the depth frame seen from the identity pose or from the given pose.
+		void Integrate(XnMDepthMetaData^ depthMeta);
+		void Integrate(XnMDepthMetaData^ depthMeta, array<Single>^ pose);
+
+		// Renders the surface seen from the given pose into a 16-bit depth map 
+		// and, if normals is not zero, into three floats per pixel of camera-space normals.
+		void Raycast(array<Single>^ pose, IntPtr depth, IntPtr normals, Int32 width, Int32 height);
+
+		// Re-extracts the triangles of blocks changed since the last call and returns their number.
+		Int32 UpdateMesh();
+		// Gets all triangles as 9 floats (three xyz vertices) each.
+		array<Single>^ GetMeshTriangles();
+		// Gets the blocks re-extracted by the last UpdateMesh and the triangles of one block
+		// (empty for blocks allocated since then).
+		array<Int32>^ GetUpdatedBlocks();
+		array<Single>^ GetBlockTriangles(Int32 block);
+
+		// Drops all fused data.
+		void Reset();
+
+		// Gets the voxel edge length in millimeters.
+		property Single VoxelSize { 
+			Single get() { return m_pVolume->GetVoxelSize(); } 
+		};
+
+		// Gets the truncation distance in millimeters.
+		property Single Truncation { 
+			Single get() { return m_pVolume->GetTruncation(); } 
+		};
+
+		// Gets the number of allocated blocks.
+		property Int32 BlockCount { 
+			Int32 get() { return m_pVolume->GetBlockCount(); } 
+		};
+
+		// Gets the block budget of the volume.
+		property Int32 MaxBlocks { 
+			Int32 get() { return m_pVolume->GetMaxBlocks(); } 
+		};
+
+		// Gets the number of blocks that could not be allocated because the budget was exhausted.
+		property Int32 DroppedBlocks { 
+			Int32 get() { return m_pVolume->GetDroppedBlockCount(); } 
+		};
+
+		// Gets or sets the depth range (mm) accepted for integration.
+		property Single MinRange { 
+			Single get() { return m_pVolume->GetMinRange(); } 
+			void set(Single value) { m_pVolume->SetRange(value, m_pVolume->GetMaxRange()); }
+		};
+
+		property Single MaxRange { 
+			Single get() { return m_pVolume->GetMaxRange(); } 
+			void set(Single value) { m_pVolume->SetRange(m_pVolume->GetMinRange(), value); }
+		};
+
+	internal:
+		property Native::TsdfVolume* Volume { 
+			Native::TsdfVolume* get() { return m_pVolume; }
+		}
+
+		property Native::DepthIntrinsics* Intrinsics { 
+			Native::DepthIntrinsics* get() { return m_pIntrinsics; }
+		}
+
+		static Native::RigidTransform ToRigidTransform(array<Single>^ pose);
+
+	private:
+		~XnMTsdfVolume();
+
+		Native::TsdfVolume* m_pVolume;
+		Native::DepthIntrinsics* m_pIntrinsics;
+		bool m_bHasIntrinsics;
+	};
+}
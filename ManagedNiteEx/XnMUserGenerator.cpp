@@ -0,0 +1,152 @@
+#include "StdAfx.h"
+#include "XnMHelper.h"
+#include "XnMUserGenerator.h"
+
+namespace ManagedNiteEx 
+{
+	XnMUserGenerator::XnMUserGenerator(xn::UserGenerator* pUserGenerator)
+		: XnMGenerator(pUserGenerator)
+	{
+		this->m_pUserGenerator = pUserGenerator;
+		this->m_pTracker = new Native::SkeletonTracker(*pUserGenerator, MaxUsers);
+		this->m_filter = gcnew XnMJointFilter(&m_pTracker->GetFilter());
+	}
+
+	XnMUserGenerator::~XnMUserGenerator()
+	{
+		Detach();
+		this->m_pUserGenerator = NULL;
+	}
+
+	void XnMUserGenerator::Detach()
+	{
+		// the tracker unregisters its callbacks from the still running generator
+		delete m_pTracker;
+		m_pTracker = NULL;
+		if (m_filter != nullptr)
+			m_filter->Detach();
+	}
+
+	Native::SkeletonTracker* XnMUserGenerator::GetTracker()
+	{
+		if (m_pTracker == NULL)
+			throw gcnew ObjectDisposedException("XnMUserGenerator");
+		return m_pTracker;
+	}
+
+	xn::SkeletonCapability XnMUserGenerator::GetSkeletonCap()
+	{
+		if (!m_pUserGenerator->IsCapabilitySupported(XN_CAPABILITY_SKELETON))
+			XnMHelper::ThrowErrorException("Skeleton capability is not supported", XN_STATUS_INVALID_OPERATION);
+
+		return m_pUserGenerator->GetSkeletonCap();
+	}
+
+	Int32 XnMUserGenerator::GetNumberOfUsers()
+	{
+		return m_pUserGenerator->GetNumberOfUsers();
+	}
+
+	array<UInt32>^ XnMUserGenerator::GetUsers()
+	{
+		XnUserID aUsers[MaxUsers];
+		XnUInt16 nUsers = MaxUsers;
+		XnStatus status = m_pUserGenerator->GetUsers(aUsers, nUsers);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to get users", status);
+		}
+
+		array<UInt32>^ users = gcnew array<UInt32>(nUsers);
+		for (Int32 i = 0; i < nUsers; ++i)
+		{
+			users[i] = aUsers[i];
+		}
+		return users;
+	}
+
+	XnMPoint3D XnMUserGenerator::GetCenterOfMass(UInt32 user)
+	{
+		XnPoint3D com;
+		XnStatus status = m_pUserGenerator->GetCoM(user, com);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to get center of mass", status);
+		}
+		return XnMPoint3D(com.X, com.Y, com.Z);
+	}
+
+	Int32 XnMUserGenerator::GetSkeletons(XnMSkeletonFrame^ frame)
+	{
+		Native::SkeletonTracker* pTracker = GetTracker();
+		XnUInt32 nUsers = pTracker->Read();
+		if (nUsers > (XnUInt32)frame->MaxUsers)
+			nUsers = frame->MaxUsers;
+
+		if (nUsers > 0)
+		{
+			pin_ptr<XnMUserSkeleton> pUsers = &frame->Users[0];
+			pin_ptr<XnMSkeletonJoint> pJoints = &frame->Joints[0];
+			memcpy(pUsers, pTracker->GetUsers(), nUsers * sizeof(Native::UserSkeleton));
+			memcpy(pJoints, pTracker->GetJoints(), nUsers * Native::SkeletonTracker::JOINT_COUNT * sizeof(Native::SkeletonJoint));
+		}
+
+		frame->SetFrame(nUsers, pTracker->GetTimestamp(), pTracker->GetFrameID());
+		return nUsers;
+	}
+
+	bool XnMUserGenerator::IsTracking(UInt32 user)
+	{
+		return GetSkeletonCap().IsTracking(user) == TRUE;
+	}
+
+	bool XnMUserGenerator::IsCalibrating(UInt32 user)
+	{
+		return GetSkeletonCap().IsCalibrating(user) == TRUE;
+	}
+
+	void XnMUserGenerator::RequestCalibration(UInt32 user, bool force)
+	{
+		XnStatus status = GetSkeletonCap().RequestCalibration(user, force);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to request calibration", status);
+		}
+	}
+
+	void XnMUserGenerator::StartTracking(UInt32 user)
+	{
+		XnStatus status = GetSkeletonCap().StartTracking(user);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to start tracking", status);
+		}
+	}
+
+	void XnMUserGenerator::StopTracking(UInt32 user)
+	{
+		XnStatus status = GetSkeletonCap().StopTracking(user);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to stop tracking", status);
+		}
+	}
+
+	void XnMUserGenerator::SetSkeletonProfile(XnMSkeletonProfile profile)
+	{
+		XnStatus status = GetSkeletonCap().SetSkeletonProfile((XnSkeletonProfile)profile);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to set skeleton profile", status);
+		}
+	}
+
+	void XnMUserGenerator::AutoTracking::set(bool value)
+	{
+		XnStatus status = GetTracker()->EnableAutoTracking(value);
+		if (status != XN_STATUS_OK)
+		{
+			XnMHelper::ThrowErrorException("Failed to change automatic tracking", status);
+		}
+	}
+}
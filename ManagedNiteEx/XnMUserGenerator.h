@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Enumerations.h"
+#include "XnMGenerator.h"
+#include "XnMPoint3D.h"
+#include "XnMSkeletonFrame.h"
+#include "XnMJointFilter.h"
+#include "Native/SkeletonTracker.h"
+
+namespace ManagedNiteEx 
+{
+	public ref class XnMUserGenerator
+		: public XnMGenerator
+	{
+	internal:
+		XnMUserGenerator(xn::UserGenerator*);
+		virtual void Detach() override;
+	private:
+		~XnMUserGenerator();
+
+	public:
+		// Maximal number of users reported in a skeleton frame
+		static const Int32 MaxUsers = 15;
+
+		Int32 GetNumberOfUsers();
+		array<UInt32>^ GetUsers();
+		XnMPoint3D GetCenterOfMass(UInt32 user);
+
+		// Fills the frame with all users and the (filtered) joints of tracked users in 
+		// one call. Returns the number of users.
+		Int32 GetSkeletons(XnMSkeletonFrame^ frame);
+
+		bool IsTracking(UInt32 user);
+		bool IsCalibrating(UInt32 user);
+		void RequestCalibration(UInt32 user, bool force);
+		void StartTracking(UInt32 user);
+		void StopTracking(UInt32 user);
+		void SetSkeletonProfile(XnMSkeletonProfile profile);
+
+		// Gets or sets whether new users are calibrated (through the calibration pose 
+		// if needed) and tracked automatically.
+		property bool AutoTracking { 
+			bool get() { return GetTracker()->IsAutoTracking(); } 
+			void set(bool value);
+		};
+
+		// Gets the filter applied to skeleton joints.
+		property XnMJointFilter^ Filter { 
+			XnMJointFilter^ get() { return m_filter; } 
+		};
+
+	protected:
+		xn::UserGenerator* m_pUserGenerator;
+
+	private:
+		xn::SkeletonCapability GetSkeletonCap();
+		Native::SkeletonTracker* GetTracker();
+
+		Native::SkeletonTracker* m_pTracker;
+		XnMJointFilter^ m_filter;
+	};
+}
@@ -20,18 +20,17 @@ namespace NiSimpleViewerWPF
 
             int numPoints = 0;
 
-            short* ptrDepth = (short*)depthMeta.Data;
-            for (int y = 0; y < depthMeta.YRes; y++)
+            XnMFrameHeader header = depthMeta.Header;
+            short* ptrDepth = (short*)header.Data;
+            int numPixels = (int)(header.XRes * header.YRes);
+            for (int i = 0; i < numPixels; i++)
             {
-                for (int x = 0; x < depthMeta.XRes; x++)
+                if (*ptrDepth != 0)
                 {
-                    if (*ptrDepth != 0)
-                    {
-                        _depthHist[*ptrDepth]++;
-                        numPoints++;
-                    }
-                    ptrDepth++;
+                    _depthHist[*ptrDepth]++;
+                    numPoints++;
                 }
+                ptrDepth++;
             }
 
             for (int i = 1; i < MaxDepth; i++)
@@ -60,17 +59,19 @@ namespace NiSimpleViewerWPF
         {
             b.Lock();
 
-            short* pDepthRow = (short*)depthMeta.Data;
+            XnMFrameHeader header = depthMeta.Header;
+
+            short* pDepthRow = (short*)header.Data;
 
             int nTexMapX = b.BackBufferStride;
-            byte* pTexRow = (byte*)b.BackBuffer + depthMeta.YOffset * nTexMapX;
+            byte* pTexRow = (byte*)b.BackBuffer + header.YOffset * nTexMapX;
 
-            for (int y = 0; y < depthMeta.YRes; y++)
+            for (int y = 0; y < header.YRes; y++)
             {
                 short* pDepth = pDepthRow;
-                byte* pTex = pTexRow + depthMeta.XOffset;
+                byte* pTex = pTexRow + header.XOffset;
 
-                for (int x = 0; x < depthMeta.XRes; x++)
+                for (int x = 0; x < header.XRes; x++)
                 {
                     if (*pDepth != 0)
                     {
@@ -92,7 +93,7 @@ namespace NiSimpleViewerWPF
                     pDepth++;
                     pTex+=4;
                 }
-                pDepthRow += depthMeta.XRes;
+                pDepthRow += header.XRes;
                 pTexRow += nTexMapX;
             }
 
@@ -104,17 +105,19 @@ namespace NiSimpleViewerWPF
         {
             b.Lock();
 
-            short* pDepthRow = (short*) depthMeta.Data;
+            XnMFrameHeader header = depthMeta.Header;
+
+            short* pDepthRow = (short*) header.Data;
 
             int nTexMapX = b.BackBufferStride / (b.Format.BitsPerPixel / 8);
-            short* pTexRow = (short*) b.BackBuffer + depthMeta.YOffset*nTexMapX;
+            short* pTexRow = (short*) b.BackBuffer + header.YOffset*nTexMapX;
 
-            for (int y = 0; y < depthMeta.YRes; y++)
+            for (int y = 0; y < header.YRes; y++)
             {
                 short* pDepth = pDepthRow;
-                short* pTex = pTexRow + depthMeta.XOffset;
+                short* pTex = pTexRow + header.XOffset;
 
-                for (int x = 0; x < depthMeta.XRes; x++)
+                for (int x = 0; x < header.XRes; x++)
                 {
                     if (*pDepth != 0)
                     {
@@ -128,7 +131,7 @@ namespace NiSimpleViewerWPF
                     pDepth++;
                     pTex++;
                 }
-                pDepthRow += depthMeta.XRes;
+                pDepthRow += header.XRes;
                 pTexRow += nTexMapX;
             }
 
@@ -175,6 +175,9 @@ namespace NiSimpleViewerWPF
             asyncData.AsyncOperation.SynchronizationContext.Send(
                 state => CreateImageBitmap(_sceneMeta, out _sceneImageSource, PixelFormats.Pbgra32),
                 null);
+
+            // the new bitmap is blank, so the first scene frame must be painted completely
+            _sceneMap.Reset();
         }
 
         private static void CreateImageBitmap(XnMMapMetaData imageMd, out WriteableBitmap writeableBitmap, PixelFormat format)
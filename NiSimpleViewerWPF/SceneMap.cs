@@ -17,56 +17,74 @@ namespace NiSimpleViewerWPF
 
         Dictionary<int, Color> _labelMap = new Dictionary<int, Color>();
 
-        public void Update(XnMSceneMetaData sceneMeta)
+        // labels are compared exactly, only changed tiles are repainted
+        private readonly XnMTileTracker _tracker = new XnMTileTracker(16, 0, 0);
+
+        // repaints the whole next frame, e.g. into a newly created bitmap
+        public void Reset()
         {
+            _tracker.Reset();
+        }
 
+        public void Update(XnMSceneMetaData sceneMeta)
+        {
+            _tracker.Update(sceneMeta);
         }
             
         public void Paint(XnMSceneMetaData sceneMeta, WriteableBitmap b)
         {
+            var dirtyRects = _tracker.GetDirtyRects();
+            if (dirtyRects.Length == 0)
+                return;
+
             b.Lock();
 
             unsafe
             {
-                short* pLabelRow = (short*)sceneMeta.Data;
-
+                int nLabelMapX = (int)sceneMeta.XRes;
                 int nTexMapX = b.BackBufferStride;
-                byte* pTexRow = (byte*)b.BackBuffer + sceneMeta.YOffset * nTexMapX;
 
-                for (int y = 0; y < sceneMeta.YRes; y++)
+                foreach (var rect in dirtyRects)
                 {
-                    short* pLabel = pLabelRow;
-                    byte* pTex = pTexRow + sceneMeta.XOffset;
+                    // dirty rects are in full frame coordinates, the label map is cropped
+                    short* pLabelRow = (short*)sceneMeta.Data +
+                        (rect.Y - (int)sceneMeta.YOffset) * nLabelMapX + (rect.X - (int)sceneMeta.XOffset);
+                    byte* pTexRow = (byte*)b.BackBuffer + rect.Y * nTexMapX + rect.X * 4;
 
-                    for (int x = 0; x < sceneMeta.XRes; x++)
+                    for (int y = 0; y < rect.Height; y++)
                     {
-                        //var label = sceneMeta.GetLabel((uint) x, (uint) y);
-                        var label = (*pLabel);
-                        if (label != 0)
-                        {
-                            var c = _colors[label%_colors.Length];
-                            pTex[0] = c.B;  // B
-                            pTex[1] = c.G;  // G
-                            pTex[2] = c.R;  // R
-                            pTex[3] = c.A;  // A
-                        }
-                        else
+                        short* pLabel = pLabelRow;
+                        byte* pTex = pTexRow;
+
+                        for (int x = 0; x < rect.Width; x++)
                         {
-                            pTex[0] = 0;  // B
-                            pTex[1] = 0;  // G
-                            pTex[2] = 0;  // R
-                            pTex[3] = 0;  // A
+                            var label = (*pLabel);
+                            if (label != 0)
+                            {
+                                var c = _colors[label%_colors.Length];
+                                pTex[0] = c.B;  // B
+                                pTex[1] = c.G;  // G
+                                pTex[2] = c.R;  // R
+                                pTex[3] = c.A;  // A
+                            }
+                            else
+                            {
+                                pTex[0] = 0;  // B
+                                pTex[1] = 0;  // G
+                                pTex[2] = 0;  // R
+                                pTex[3] = 0;  // A
+                            }
+                            pLabel++;
+                            pTex += 4;
                         }
-                        pLabel++;
-                        pTex += 4;
+                        pLabelRow += nLabelMapX;
+                        pTexRow += nTexMapX;
                     }
-                    pLabelRow += sceneMeta.XRes;
-                    pTexRow += nTexMapX;
+
+                    b.AddDirtyRect(new Int32Rect(rect.X, rect.Y, rect.Width, rect.Height));
                 }
             }
-            b.AddDirtyRect(new Int32Rect(0, 0, b.PixelWidth, b.PixelHeight));
             b.Unlock();
-
         }
     }
 }
\ No newline at end of file